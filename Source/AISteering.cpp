@@ -0,0 +1,116 @@
+#include "AISteering.h"
+
+#include <math.h>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define AI_STEER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define AI_STEER_SSE
+#endif
+
+static const float deadband_tan = tanf(AI_STEER_DEADBAND);
+
+static inline float SteerOne(float x, float y, float heading_x, float heading_y, float target_x, float target_y, float amount)
+{
+	float dx = target_x - x;
+	float dy = target_y - y;
+
+	float cross = heading_x * dy - heading_y * dx;  // |d| * sin(difference)
+	float dot = heading_x * dx + heading_y * dy;    // |d| * cos(difference)
+
+	// Behind the car (dot <= 0) any side is out of the dead band
+	float limit = deadband_tan * dot;
+	if (limit < 0.0f) limit = 0.0f;
+
+	if (cross > limit) return amount;
+	if (-cross > limit) return -amount;
+	return 0.0f;
+}
+
+void ComputeAISteering(const float* x, const float* y, const float* heading_x, const float* heading_y,
+	const float* target_x, const float* target_y, float* steering, int count, float amount)
+{
+	int i = 0;
+
+#if defined(AI_STEER_AVX)
+	const __m256 tan8 = _mm256_set1_ps(deadband_tan);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 amount8 = _mm256_set1_ps(amount);
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 hx = _mm256_loadu_ps(heading_x + i);
+		__m256 hy = _mm256_loadu_ps(heading_y + i);
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(target_x + i), _mm256_loadu_ps(x + i));
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(target_y + i), _mm256_loadu_ps(y + i));
+
+		__m256 cross = _mm256_sub_ps(_mm256_mul_ps(hx, dy), _mm256_mul_ps(hy, dx));
+		__m256 dot = _mm256_add_ps(_mm256_mul_ps(hx, dx), _mm256_mul_ps(hy, dy));
+		__m256 limit = _mm256_max_ps(_mm256_mul_ps(tan8, dot), zero);
+
+		// |cross| > limit: steer by amount with the sign of cross
+		__m256 outside = _mm256_cmp_ps(_mm256_andnot_ps(sign, cross), limit, _CMP_GT_OQ);
+		__m256 result = _mm256_and_ps(outside, _mm256_or_ps(amount8, _mm256_and_ps(cross, sign)));
+		_mm256_storeu_ps(steering + i, result);
+	}
+#elif defined(AI_STEER_SSE)
+	const __m128 tan4 = _mm_set1_ps(deadband_tan);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 amount4 = _mm_set1_ps(amount);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 hx = _mm_loadu_ps(heading_x + i);
+		__m128 hy = _mm_loadu_ps(heading_y + i);
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(target_x + i), _mm_loadu_ps(x + i));
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(target_y + i), _mm_loadu_ps(y + i));
+
+		__m128 cross = _mm_sub_ps(_mm_mul_ps(hx, dy), _mm_mul_ps(hy, dx));
+		__m128 dot = _mm_add_ps(_mm_mul_ps(hx, dx), _mm_mul_ps(hy, dy));
+		__m128 limit = _mm_max_ps(_mm_mul_ps(tan4, dot), zero);
+
+		// |cross| > limit: steer by amount with the sign of cross
+		__m128 outside = _mm_cmpgt_ps(_mm_andnot_ps(sign, cross), limit);
+		__m128 result = _mm_and_ps(outside, _mm_or_ps(amount4, _mm_and_ps(cross, sign)));
+		_mm_storeu_ps(steering + i, result);
+	}
+#endif
+
+	// Remainder (or everything without SIMD)
+	for (; i < count; ++i)
+		steering[i] = SteerOne(x[i], y[i], heading_x[i], heading_y[i], target_x[i], target_y[i], amount);
+}
+
+void ComputeAISteeringReference(const float* x, const float* y, const float* angle,
+	const float* target_x, const float* target_y, float* steering, int count)
+{
+	const float pi = 3.14159265358979323846f;
+
+	for (int i = 0; i < count; ++i)
+	{
+		float target_angle = atan2f(target_y[i] - y[i], target_x[i] - x[i]);
+		float diff = target_angle - angle[i];
+
+		while (diff > pi) diff -= 2.0f * pi;
+		while (diff < -pi) diff += 2.0f * pi;
+
+		if (diff > AI_STEER_DEADBAND) steering[i] = AI_STEER_AMOUNT;
+		else if (diff < -AI_STEER_DEADBAND) steering[i] = -AI_STEER_AMOUNT;
+		else steering[i] = 0.0f;
+	}
+}
+
+const char* GetAISteeringPath()
+{
+#if defined(AI_STEER_AVX)
+	return "AVX";
+#elif defined(AI_STEER_SSE)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#define AI_STEER_DEADBAND 0.08f     // radians either side of the target with no steering
+#define AI_STEER_AMOUNT 0.6f
+
+// Steering of a batch of cars chasing a target point each. Arrays hold count
+// entries: car position, heading as a unit vector (cosine, sine of the body
+// angle) and target, all map pixels. Writes -amount, 0 or amount.
+// No atan2 and no angle wrapping: the sign of cross(heading, to target) says on
+// which side the target is and comparing it with tan(dead band) * dot tells
+// whether it is outside the dead band. 8 cars per instruction with AVX, 4 with
+// SSE2 (picked at compile time, /arch:AVX or -mavx), scalar loop otherwise
+void ComputeAISteering(const float* x, const float* y, const float* heading_x, const float* heading_y,
+	const float* target_x, const float* target_y, float* steering, int count, float amount = AI_STEER_AMOUNT);
+
+// The same decision one car at a time from the body angle, through atan2 and
+// wrapping the difference, as the AI used to do it. Reference for the benchmark
+void ComputeAISteeringReference(const float* x, const float* y, const float* angle,
+	const float* target_x, const float* target_y, float* steering, int count);
+
+// Instruction set ComputeAISteering was built for: "AVX", "SSE2" or "scalar"
+const char* GetAISteeringPath();
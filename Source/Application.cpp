@@ -5,14 +5,23 @@
 #include "ModuleAudio.h"
 #include "ModulePhysics.h"
 #include "ModuleGame.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Trace.h"
 
 #include "Application.h"
 
-Application::Application()
+Application::Application(bool _headless) : headless(_headless)
 {
-	window = new ModuleWindow(this);
-	renderer = new ModuleRender(this);
-	audio = new ModuleAudio(this, true);
+	jobs = new JobSystem();
+	profiler = new Profiler();
+
+	if (!headless)
+	{
+		window = new ModuleWindow(this);
+		renderer = new ModuleRender(this);
+	}
+	audio = new ModuleAudio(this, !headless);
 	physics = new ModulePhysics(this);
 	scene_intro = new ModuleGame(this);
 
@@ -21,15 +30,15 @@ Application::Application()
 	// They will CleanUp() in reverse order
 
 	// Main Modules
-	AddModule(window);
-	AddModule(physics);
-	AddModule(audio);
+	if (window != NULL) AddModule(window, "Window");
+	AddModule(physics, "Physics");
+	AddModule(audio, "Audio");
 	
 	// Scenes
-	AddModule(scene_intro);
+	AddModule(scene_intro, "Game");
 
 	// Rendering happens at the end
-	AddModule(renderer);
+	if (renderer != NULL) AddModule(renderer, "Render");
 }
 
 Application::~Application()
@@ -40,27 +49,30 @@ Application::~Application()
 		delete item;
 	}
 	list_modules.clear();
-	
+
+	delete jobs;
+	delete profiler;
 }
 
 bool Application::Init()
 {
-	bool ret = true;
+	bool ret = jobs->Init(worker_count);
+	LOG("Job system: %d threads", jobs->GetThreadCount());
 
 	// Call Init() in all modules
-	for (auto it = list_modules.begin(); it != list_modules.end() && ret; ++it)
+	for (size_t i = 0; i < list_modules.size() && ret; ++i)
 	{
-		Module* module = *it;
-		ret = module->Init();
+		TRACE_SCOPE(module_names[i], "Init");
+		ret = list_modules[i]->Init();
 	}
 
 	// After all Init calls we call Start() in all modules
 	LOG("Application Start --------------");
 
-	for (auto it = list_modules.begin(); it != list_modules.end() && ret; ++it)
+	for (size_t i = 0; i < list_modules.size() && ret; ++i)
 	{
-		Module* module = *it;
-		ret = module->Start();
+		TRACE_SCOPE(module_names[i], "Start");
+		ret = list_modules[i]->Start();
 	}
 	
 	return ret;
@@ -71,34 +83,51 @@ update_status Application::Update()
 {
 	update_status ret = UPDATE_CONTINUE;
 
-	for (auto it = list_modules.begin(); it != list_modules.end() && ret == UPDATE_CONTINUE; ++it)
+	profiler->BeginFrame();
+	TraceBegin("Frame");
+
+	for (size_t i = 0; i < list_modules.size() && ret == UPDATE_CONTINUE; ++i)
 	{
-		Module* module = *it;
+		Module* module = list_modules[i];
 		if (module->IsEnabled())
 		{
+			ProfileScope scope(profiler, module_names[i], "PreUpdate");
+			TRACE_SCOPE(module_names[i], "PreUpdate");
 			ret = module->PreUpdate();
 		}
 	}
 
-	for (auto it = list_modules.begin(); it != list_modules.end() && ret == UPDATE_CONTINUE; ++it)
+	// Headless does not follow the clock: exactly one tick per loop, as fast as it goes
+	if (ret == UPDATE_CONTINUE)
+		ret = FixedUpdate(headless ? FIXED_TIMESTEP : GetFrameTime());
+
+	for (size_t i = 0; i < list_modules.size() && ret == UPDATE_CONTINUE; ++i)
 	{
-		Module* module = *it;
+		Module* module = list_modules[i];
 		if (module->IsEnabled())
 		{
+			ProfileScope scope(profiler, module_names[i], "Update");
+			TRACE_SCOPE(module_names[i], "Update");
 			ret = module->Update();
 		}
 	}
 
-	for (auto it = list_modules.begin(); it != list_modules.end() && ret == UPDATE_CONTINUE; ++it)
+	for (size_t i = 0; i < list_modules.size() && ret == UPDATE_CONTINUE; ++i)
 	{
-		Module* module = *it;
+		Module* module = list_modules[i];
 		if (module->IsEnabled())
 		{
+			ProfileScope scope(profiler, module_names[i], "PostUpdate");
+			TRACE_SCOPE(module_names[i], "PostUpdate");
 			ret = module->PostUpdate();
 		}
 	}
 
-	if (WindowShouldClose()) ret = UPDATE_STOP;
+	TraceEnd();
+	profiler->EndFrame();
+
+	if (!headless && WindowShouldClose()) ret = UPDATE_STOP;
+	if (tick_limit != 0 && tick_count >= tick_limit) ret = UPDATE_STOP;
 
 	return ret;
 }
@@ -111,11 +140,128 @@ bool Application::CleanUp()
 		Module* item = *it;
 		ret = item->CleanUp();
 	}
-	
+
+	jobs->CleanUp();
+
+	if (profile_path != NULL && !profiler->Dump(profile_path))
+		LOG("Cannot write profile: %s", profile_path);
+
 	return ret;
 }
 
-void Application::AddModule(Module* mod)
+float Application::GetFixedAlpha() const
+{
+	return fixed_alpha;
+}
+
+uint64 Application::GetTickCount() const
+{
+	return tick_count;
+}
+
+bool Application::IsHeadless() const
+{
+	return headless;
+}
+
+void Application::SetTickLimit(uint64 ticks)
+{
+	tick_limit = ticks;
+}
+
+void Application::SetWorkerCount(int workers)
+{
+	worker_count = workers;
+}
+
+void Application::SetSeed(uint64 race_seed)
+{
+	seed = race_seed;
+}
+
+uint64 Application::GetSeed() const
+{
+	return seed;
+}
+
+void Application::SetCarCount(int cars)
+{
+	car_count = cars;
+}
+
+int Application::GetCarCount() const
+{
+	return car_count;
+}
+
+void Application::SetRecordPath(const char* path)
+{
+	record_path = path;
+}
+
+void Application::SetReplayPath(const char* path)
+{
+	replay_path = path;
+}
+
+const char* Application::GetRecordPath() const
+{
+	return record_path;
+}
+
+const char* Application::GetReplayPath() const
+{
+	return replay_path;
+}
+
+void Application::SetProfilePath(const char* path)
+{
+	profile_path = path;
+}
+
+const char* Application::GetProfilePath() const
+{
+	return profile_path;
+}
+
+void Application::AddModule(Module* mod, const char* name)
 {
 	list_modules.emplace_back(mod);
+	module_names.emplace_back(name);
+}
+
+// Run as many fixed ticks as fit in the time elapsed, the remainder carries to the next frame
+update_status Application::FixedUpdate(float frame_time)
+{
+	update_status ret = UPDATE_CONTINUE;
+	uint64 first_tick = tick_count;
+
+	fixed_accumulator += MIN(frame_time, MAX_FRAME_TIME);
+
+	while (fixed_accumulator >= FIXED_TIMESTEP && ret == UPDATE_CONTINUE)
+	{
+		ProfileScope tick(profiler, "Tick");
+		TRACE_SCOPE("Tick");
+
+		for (size_t i = 0; i < list_modules.size() && ret == UPDATE_CONTINUE; ++i)
+		{
+			Module* module = list_modules[i];
+			if (module->IsEnabled())
+			{
+				ProfileScope scope(profiler, module_names[i], "FixedUpdate");
+				TRACE_SCOPE(module_names[i], "FixedUpdate");
+				ret = module->FixedUpdate(FIXED_TIMESTEP);
+			}
+		}
+
+		fixed_accumulator -= FIXED_TIMESTEP;
+		tick_count++;
+	}
+
+	fixed_alpha = fixed_accumulator / FIXED_TIMESTEP;
+
+	// Catching up on a slow frame shows as several ticks in one frame
+	TraceCounter("Ticks per frame", (double)(tick_count - first_tick));
+
+	return ret;
 }
\ No newline at end of file
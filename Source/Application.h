@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Globals.h"
-#include "Timer.h"
 #include <vector>
 
 class Module;
@@ -10,40 +9,80 @@ class ModuleRender;
 class ModuleAudio;
 class ModulePhysics;
 class ModuleGame;
+class JobSystem;
+class Profiler;
 
 class Application
 {
 public:
 
-	ModuleRender* renderer;
-	ModuleWindow* window;
+	ModuleRender* renderer = NULL;	// NULL when headless
+	ModuleWindow* window = NULL;	// NULL when headless
 	ModuleAudio* audio;
 	ModulePhysics* physics;
 	ModuleGame* scene_intro;
 
+	// Worker threads shared by every module
+	JobSystem* jobs;
+
+	// Frame timings, every module phase is a scope
+	Profiler* profiler;
+
 private:
 
 	std::vector<Module*> list_modules;
-    uint64 frame_count = 0;
+	std::vector<const char*> module_names;     // profiler scope names, same order
 
-	Timer ptimer;
-	Timer startup_time;
-	Timer frame_time;
-	Timer last_sec_frame_time;
+	float fixed_accumulator = 0.0f;
+	float fixed_alpha = 0.0f;
+	uint64 tick_count = 0;
 
-	uint32 last_sec_frame_count = 0;
-	uint32 prev_last_sec_frame_count = 0;
+	bool headless = false;
+	uint64 tick_limit = 0;
+	int worker_count = -1;
+	uint64 seed = 0;
+	int car_count = 0;
+	const char* record_path = NULL;
+	const char* replay_path = NULL;
+	const char* profile_path = NULL;
 
 public:
 
-	Application();
+	// Headless runs the simulation alone: no window, no GPU, no audio device,
+	// one fixed tick per Update() with no frame cap
+	Application(bool headless = false);
 	~Application();
 
 	bool Init();
 	update_status Update();
 	bool CleanUp();
 
+	// How far the frame is between the last two fixed ticks [0, 1), for interpolation
+	float GetFixedAlpha() const;
+	uint64 GetTickCount() const;
+
+	bool IsHeadless() const;
+	// Stop after this many fixed ticks, 0 runs until a module stops
+	void SetTickLimit(uint64 ticks);
+	// Job system threads besides the main one, negative for one per extra core. Before Init()
+	void SetWorkerCount(int workers);
+	// Race seed for every random decision, 0 picks one from the clock
+	void SetSeed(uint64 race_seed);
+	uint64 GetSeed() const;
+	// AI cars in the race, spread around the whole lap; 0 for the usual starting grid
+	void SetCarCount(int cars);
+	int GetCarCount() const;
+	// Record the player's race to a file / drive the player from a recorded race, NULL for none
+	void SetRecordPath(const char* path);
+	void SetReplayPath(const char* path);
+	const char* GetRecordPath() const;
+	const char* GetReplayPath() const;
+	// Dump the profiler history there on CleanUp(), NULL for none
+	void SetProfilePath(const char* path);
+	const char* GetProfilePath() const;
+
 private:
 
-	void AddModule(Module* module);
+	void AddModule(Module* module, const char* name);
+	update_status FixedUpdate(float frame_time);
 };
\ No newline at end of file
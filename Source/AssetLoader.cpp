@@ -0,0 +1,161 @@
+#include "AssetLoader.h"
+#include "ModuleAudio.h"
+#include "Trace.h"
+
+#include "raylib.h"
+
+AssetLoader::AssetLoader() : jobs(nullptr), pending(0), finished(0), failed(0)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+}
+
+void AssetLoader::AddTexture(const char* path, Texture2D* texture)
+{
+	assets.emplace_back();
+	Asset& asset = assets.back();
+	asset.kind = ASSET_TEXTURE;
+	asset.path = path;
+	asset.texture = texture;
+}
+
+void AssetLoader::AddSound(const char* path, ModuleAudio* audio, uint32* fx)
+{
+	assets.emplace_back();
+	Asset& asset = assets.back();
+	asset.kind = ASSET_SOUND;
+	asset.path = path;
+	asset.audio = audio;
+	asset.fx = fx;
+}
+
+void AssetLoader::AddTask(const char* name, std::function<bool()> task)
+{
+	assets.emplace_back();
+	Asset& asset = assets.back();
+	asset.kind = ASSET_TASK;
+	asset.path = name;
+	asset.task = std::move(task);
+}
+
+void AssetLoader::Start(JobSystem* jobs)
+{
+	this->jobs = jobs;
+	for (Asset& asset : assets)
+		jobs->Schedule([this, &asset]() { Decode(asset); }, pending);
+}
+
+// Worker: file to pixels / samples, nothing that needs the GPU or the audio device
+void AssetLoader::Decode(Asset& asset)
+{
+	TRACE_SCOPE("Decode asset", asset.path);
+
+	switch (asset.kind)
+	{
+	case ASSET_TEXTURE:
+		asset.image = LoadImage(asset.path);
+		asset.ok = asset.image.data != NULL;
+		break;
+	case ASSET_SOUND:
+		asset.wave = LoadWave(asset.path);
+		asset.ok = asset.wave.data != NULL;
+		break;
+	case ASSET_TASK:
+		asset.ok = asset.task();
+		break;
+	}
+
+	asset.decoded.store(true, std::memory_order_release);
+}
+
+// Main thread: upload what the job decoded and free the CPU copy
+void AssetLoader::Finish(Asset& asset)
+{
+	TRACE_SCOPE("Finish asset", asset.path);
+
+	if (!asset.ok)
+	{
+		LOG("Cannot load asset: %s", asset.path);
+		failed++;
+		return;
+	}
+
+	switch (asset.kind)
+	{
+	case ASSET_TEXTURE:
+		*asset.texture = LoadTextureFromImage(asset.image);
+		UnloadImage(asset.image);
+		asset.image = Image{};
+		break;
+	case ASSET_SOUND:
+		*asset.fx = asset.audio->LoadFx(asset.wave);
+		UnloadWave(asset.wave);
+		asset.wave = Wave{};
+		break;
+	case ASSET_TASK:
+		break;
+	}
+}
+
+bool AssetLoader::Update(float budget_ms)
+{
+	double start = GetTime();
+	bool no_workers = jobs != nullptr && jobs->GetThreadCount() == 1;
+
+	while (finished < (int)assets.size())
+	{
+		Asset& asset = assets[finished];
+		if (asset.decoded.load(std::memory_order_acquire))
+		{
+			Finish(asset);
+			finished++;
+		}
+		else if (!no_workers || !jobs->RunPending())
+		{
+			// Still decoding on a worker, next frame
+			break;
+		}
+
+		if ((GetTime() - start) * 1000.0 >= budget_ms) break;
+	}
+
+	return IsDone();
+}
+
+void AssetLoader::Clear()
+{
+	if (jobs != nullptr) jobs->Wait(pending);
+
+	for (int i = finished; i < (int)assets.size(); ++i)
+	{
+		if (assets[i].image.data != NULL) UnloadImage(assets[i].image);
+		if (assets[i].wave.data != NULL) UnloadWave(assets[i].wave);
+	}
+
+	assets.clear();
+	jobs = nullptr;
+	finished = 0;
+	failed = 0;
+}
+
+bool AssetLoader::IsDone() const
+{
+	return finished == (int)assets.size();
+}
+
+float AssetLoader::GetProgress() const
+{
+	return assets.empty() ? 1.0f : (float)finished / (float)assets.size();
+}
+
+const char* AssetLoader::GetCurrentName() const
+{
+	return IsDone() ? "" : assets[finished].path;
+}
+
+int AssetLoader::GetFailedCount() const
+{
+	return failed;
+}
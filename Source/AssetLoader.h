@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Globals.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+
+class ModuleAudio;
+
+// Asset loading in two halves. Reading and decoding the files (PNG, MP3, WAV)
+// runs as jobs, all of them at once on the job system workers. Creating the GPU
+// textures and the sounds runs on the main thread, in the order the assets were
+// added, as many per frame as fit in a time budget. The game keeps drawing its
+// loading screen meanwhile and the whole load takes about as long as the slowest
+// decode. With no workers the main thread runs the decodes itself, within the
+// same budget. Paths are kept as pointers: pass string literals
+class AssetLoader
+{
+public:
+	AssetLoader();
+	~AssetLoader();
+
+	// Assets to load, added before Start(). Results are written on the main thread
+	void AddTexture(const char* path, Texture2D* texture);
+	void AddSound(const char* path, ModuleAudio* audio, uint32* fx);
+
+	// Any other CPU only work (no GPU, no audio device), run as one more job
+	void AddTask(const char* name, std::function<bool()> task);
+
+	void Start(JobSystem* jobs);
+
+	// Main thread, once per frame: finishes assets for up to budget_ms, true once all are done
+	bool Update(float budget_ms);
+
+	// Waits for the decodes still running and drops what was never finished
+	void Clear();
+
+	bool IsDone() const;
+	float GetProgress() const;              // 0..1
+	const char* GetCurrentName() const;     // next asset to finish, "" when done
+	int GetFailedCount() const;
+
+private:
+	enum AssetKind
+	{
+		ASSET_TEXTURE,
+		ASSET_SOUND,
+		ASSET_TASK
+	};
+
+	struct Asset
+	{
+		AssetKind kind = ASSET_TASK;
+		const char* path = nullptr;
+		Texture2D* texture = nullptr;
+		ModuleAudio* audio = nullptr;
+		uint32* fx = nullptr;
+		std::function<bool()> task;
+
+		// Written by the job, read on the main thread once decoded is set
+		Image image = {};
+		Wave wave = {};
+		bool ok = false;
+		std::atomic<bool> decoded{ false };
+	};
+
+	void Decode(Asset& asset);
+	void Finish(Asset& asset);
+
+private:
+	std::deque<Asset> assets;       // stable addresses for the jobs
+	JobSystem* jobs;
+	JobCounter pending;
+	int finished;                   // assets [0, finished) are done
+	int failed;
+};
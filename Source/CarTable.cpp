@@ -0,0 +1,114 @@
+#include "CarTable.h"
+
+#define NO_LAP_TIME 999999.0f
+
+void CarTable::Clear()
+{
+	body.clear();
+	x.clear();
+	y.clear();
+	angle.clear();
+	heading_x.clear();
+	heading_y.clear();
+	speed.clear();
+	is_ai.clear();
+	forward_input.clear();
+	steering_input.clear();
+	hard_brake.clear();
+	steering_visual.clear();
+	target_x.clear();
+	target_y.clear();
+	line_distance.clear();
+	recover_checkpoint.clear();
+	rng.clear();
+	track.clear();
+	lap_start.clear();
+	lap_current.clear();
+	lap_last.clear();
+	lap_best.clear();
+	grid_track.clear();
+	grid_line.clear();
+}
+
+void CarTable::Reserve(int count)
+{
+	body.reserve(count);
+	x.reserve(count);
+	y.reserve(count);
+	angle.reserve(count);
+	heading_x.reserve(count);
+	heading_y.reserve(count);
+	speed.reserve(count);
+	is_ai.reserve(count);
+	forward_input.reserve(count);
+	steering_input.reserve(count);
+	hard_brake.reserve(count);
+	steering_visual.reserve(count);
+	target_x.reserve(count);
+	target_y.reserve(count);
+	line_distance.reserve(count);
+	recover_checkpoint.reserve(count);
+	rng.reserve(count);
+	track.reserve(count);
+	lap_start.reserve(count);
+	lap_current.reserve(count);
+	lap_last.reserve(count);
+	lap_best.reserve(count);
+	grid_track.reserve(count);
+	grid_line.reserve(count);
+}
+
+int CarTable::Add(PhysBody* _body, bool ai)
+{
+	body.push_back(_body);
+	x.push_back(0.0f);
+	y.push_back(0.0f);
+	angle.push_back(0.0f);
+	heading_x.push_back(1.0f);
+	heading_y.push_back(0.0f);
+	speed.push_back(0.0f);
+	is_ai.push_back(ai ? 1 : 0);
+	forward_input.push_back(0.0f);
+	steering_input.push_back(0.0f);
+	hard_brake.push_back(0);
+	steering_visual.push_back(0.0f);
+	target_x.push_back(0.0f);
+	target_y.push_back(0.0f);
+	line_distance.push_back(0.0f);
+	recover_checkpoint.push_back(-1);
+	rng.push_back(Pcg32());
+	track.push_back(TrackPosition());
+	lap_start.push_back(0.0f);
+	lap_current.push_back(0.0f);
+	lap_last.push_back(0.0f);
+	lap_best.push_back(NO_LAP_TIME);
+	grid_track.push_back(TrackPosition());
+	grid_line.push_back(0.0f);
+
+	return (int)body.size() - 1;
+}
+
+int CarTable::Size() const
+{
+	return (int)body.size();
+}
+
+void CarTable::ResetRace(float start_time)
+{
+	for (int i = 0; i < Size(); ++i)
+	{
+		track[i] = grid_track[i];
+		line_distance[i] = grid_line[i];
+		recover_checkpoint[i] = -1;
+		lap_start[i] = start_time;
+		lap_current[i] = 0.0f;
+		lap_last[i] = 0.0f;
+		lap_best[i] = NO_LAP_TIME;
+	}
+}
+
+void CarTable::SeedRandom(uint64 seed)
+{
+	for (int i = 0; i < Size(); ++i)
+		rng[i].Seed(seed, (uint64)i);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Globals.h"
+#include "TrackProgress.h"
+#include "Random.h"
+
+#include <vector>
+
+class PhysBody;
+
+#define CAR_PLAYER 0
+
+// Every car of the race as a structure of arrays: one column per field and car i
+// is row i of every column. Car 0 is the player, 1..N the AI. The per tick loops
+// only walk the columns they use, contiguous, with no per-car object to chase
+class CarTable
+{
+public:
+	void Clear();
+	void Reserve(int count);
+	int Add(PhysBody* body, bool ai);
+	int Size() const;
+
+	// Everybody back to its grid position, lap timers counting from start_time
+	void ResetRace(float start_time);
+
+	// Car i draws from stream i of seed: same seed, same decisions
+	void SeedRandom(uint64 seed);
+
+public:
+	std::vector<PhysBody*> body;
+
+	// Kinematics, gathered from the bodies at the start of every tick
+	std::vector<float> x;               // map pixels
+	std::vector<float> y;
+	std::vector<float> angle;           // radians
+	std::vector<float> heading_x;       // cosine and sine of angle
+	std::vector<float> heading_y;
+	std::vector<float> speed;
+
+	// Controls
+	std::vector<uchar> is_ai;
+	std::vector<float> forward_input;
+	std::vector<float> steering_input;
+	std::vector<uchar> hard_brake;
+	std::vector<float> steering_visual;
+	std::vector<float> target_x;        // point the AI steers to, map pixels
+	std::vector<float> target_y;
+	std::vector<float> line_distance;   // along the racing line, pixels
+	std::vector<int> recover_checkpoint; // checkpoint the AI missed and drives back to, -1 none
+	std::vector<Pcg32> rng;             // own random stream per car
+
+	// Race
+	std::vector<TrackPosition> track;
+	std::vector<float> lap_start;
+	std::vector<float> lap_current;
+	std::vector<float> lap_last;
+	std::vector<float> lap_best;
+
+	// Where every car starts the race: lap 0 at checkpoint 0 on the usual grid,
+	// further back along the lap for a field spread around the track
+	std::vector<TrackPosition> grid_track;
+	std::vector<float> grid_line;
+};
@@ -0,0 +1,146 @@
+#include "EngineSynth.h"
+
+#include <math.h>
+#include <string.h>
+
+static const float two_pi = 6.28318530717958647692f;
+
+// Firing frequency from idle to redline, Hz
+static const float idle_hz = 38.0f;
+static const float redline_hz = 240.0f;
+
+// Seconds the parameters take to get most of the way to a new value
+static const float glide_time = 0.02f;
+
+// Headroom: a dozen voices at full volume still stay under the clipping level most of the time
+static const float voice_gain = 0.12f;
+
+EngineSynth::EngineSynth() : sample_rate(44100), glide(1.0f)
+{
+	memset(sine, 0, sizeof(sine));
+}
+
+void EngineSynth::Init(int sample_rate)
+{
+	this->sample_rate = sample_rate;
+	glide = 1.0f - expf(-1.0f / (glide_time * sample_rate));
+
+	const int size = 1 << ENGINE_SINE_BITS;
+	for (int i = 0; i < size; ++i)
+		sine[i] = sinf(two_pi * i / size);
+
+	for (int v = 0; v < ENGINE_MAX_VOICES; ++v)
+	{
+		voices[v] = Voice();
+		voices[v].noise_state = 0x9E3779B9u * (v + 1);
+	}
+	SilenceAll();
+}
+
+void EngineSynth::SetVoice(int voice, float rpm, float throttle, float volume, float pan, bool restart)
+{
+	if (voice < 0 || voice >= ENGINE_MAX_VOICES) return;
+
+	Target& target = targets[voice];
+	target.rpm.store(MAX(0.0f, MIN(rpm, 1.0f)), std::memory_order_relaxed);
+	target.throttle.store(MAX(0.0f, MIN(throttle, 1.0f)), std::memory_order_relaxed);
+	target.volume.store(MAX(0.0f, MIN(volume, 1.0f)), std::memory_order_relaxed);
+	target.pan.store(MAX(-1.0f, MIN(pan, 1.0f)), std::memory_order_relaxed);
+
+	// Published after the targets, the mixing thread sees them once it sees the restart
+	if (restart) target.generation.fetch_add(1, std::memory_order_release);
+}
+
+void EngineSynth::Silence(int voice)
+{
+	if (voice < 0 || voice >= ENGINE_MAX_VOICES) return;
+	targets[voice].volume.store(0.0f, std::memory_order_relaxed);
+}
+
+void EngineSynth::SilenceAll()
+{
+	for (int v = 0; v < ENGINE_MAX_VOICES; ++v)
+		targets[v].volume.store(0.0f, std::memory_order_relaxed);
+}
+
+float EngineSynth::Sine(uint32 phase) const
+{
+	return sine[phase >> (32 - ENGINE_SINE_BITS)];
+}
+
+void EngineSynth::Mix(float* out, unsigned int frames)
+{
+	memset(out, 0, sizeof(float) * 2 * frames);
+
+	for (int v = 0; v < ENGINE_MAX_VOICES; ++v)
+		MixVoice(voices[v], targets[v], out, frames);
+
+	for (unsigned int i = 0; i < 2 * frames; ++i)
+		out[i] = MAX(-1.0f, MIN(out[i], 1.0f));
+}
+
+void EngineSynth::MixVoice(Voice& voice, const Target& target, float* out, unsigned int frames)
+{
+	// Restarted with another motor: jump to it and fade in from silence
+	uint32 generation = target.generation.load(std::memory_order_acquire);
+	bool restart = generation != voice.generation;
+	voice.generation = generation;
+
+	float target_volume = target.volume.load(std::memory_order_relaxed);
+
+	// Silent and staying silent: nothing to glide, nothing to mix
+	if (target_volume == 0.0f && voice.volume < 0.0001f)
+	{
+		voice.volume = 0.0f;
+		return;
+	}
+
+	float target_rpm = target.rpm.load(std::memory_order_relaxed);
+	float target_throttle = target.throttle.load(std::memory_order_relaxed);
+
+	// Equal power pan
+	float pan_angle = (target.pan.load(std::memory_order_relaxed) + 1.0f) * (two_pi / 8.0f);
+	float target_left = cosf(pan_angle);
+	float target_right = sinf(pan_angle);
+
+	if (restart)
+	{
+		voice.rpm = target_rpm;
+		voice.throttle = target_throttle;
+		voice.volume = 0.0f;
+		voice.left = target_left;
+		voice.right = target_right;
+	}
+
+	const float phase_scale = 4294967296.0f / sample_rate;
+
+	for (unsigned int f = 0; f < frames; ++f)
+	{
+		voice.rpm += (target_rpm - voice.rpm) * glide;
+		voice.throttle += (target_throttle - voice.throttle) * glide;
+		voice.volume += (target_volume - voice.volume) * glide;
+		voice.left += (target_left - voice.left) * glide;
+		voice.right += (target_right - voice.right) * glide;
+
+		uint32 increment = (uint32)((idle_hz + voice.rpm * (redline_hz - idle_hz)) * phase_scale);
+		voice.phase += increment;
+		voice.sub_phase += increment >> 1;
+
+		// Harmonics: the throttle brings the upper one up, a harsher, louder motor
+		float firing = Sine(voice.phase);
+		float sample = firing + 0.5f * Sine(voice.phase * 2) + (0.15f + 0.35f * voice.throttle) * Sine(voice.phase * 3)
+			+ 0.4f * Sine(voice.sub_phase);
+
+		// Combustion noise (xorshift, low passed) in bursts with every firing
+		voice.noise_state ^= voice.noise_state << 13;
+		voice.noise_state ^= voice.noise_state >> 17;
+		voice.noise_state ^= voice.noise_state << 5;
+		float white = (int)voice.noise_state * (1.0f / 2147483648.0f);
+		voice.noise += (white - voice.noise) * 0.25f;
+		sample += voice.noise * (0.5f + 0.5f * firing) * (0.3f + 0.9f * voice.throttle);
+
+		sample *= voice.volume * (0.6f + 0.4f * voice.throttle) * voice_gain;
+		out[2 * f] += sample * voice.left;
+		out[2 * f + 1] += sample * voice.right;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+
+#define ENGINE_MAX_VOICES 16
+#define ENGINE_SINE_BITS 11             // sine table of 2048 samples
+
+// Procedural engine sound: every voice is a motor made of a few harmonics of the
+// firing frequency plus combustion noise pulsing with it. The rpm (0 idle .. 1
+// redline) sets the pitch, the throttle how rough and loud it sounds. Mix() runs
+// on raylib's mixing thread and adds every voice into a stereo float buffer. The
+// voice parameters are atomics set from the thread driving the synth, the mixing
+// thread glides to them sample by sample, so a parameter change never clicks. A voice handed to
+// another car is restarted instead: it jumps to the new motor and fades in
+class EngineSynth
+{
+public:
+	EngineSynth();
+
+	void Init(int sample_rate);
+
+	// Driving thread. volume 0 silences the voice (and skips it), pan -1 left .. 1 right.
+	// restart: the voice now plays another motor, no glide from the old one
+	void SetVoice(int voice, float rpm, float throttle, float volume, float pan, bool restart = false);
+	void Silence(int voice);
+	void SilenceAll();
+
+	// Mixing thread: frames stereo frames, interleaved left/right, overwritten
+	void Mix(float* out, unsigned int frames);
+
+private:
+	struct Target
+	{
+		std::atomic<float> rpm{ 0.0f };
+		std::atomic<float> throttle{ 0.0f };
+		std::atomic<float> volume{ 0.0f };
+		std::atomic<float> pan{ 0.0f };
+		std::atomic<uint32> generation{ 0 };   // bumped by every restart
+	};
+
+	// Owned by the mixing thread
+	struct Voice
+	{
+		uint32 phase = 0;           // firing frequency, the whole 32 bits are one cycle
+		uint32 sub_phase = 0;       // half of it, the rumble of every other cylinder
+		float rpm = 0.0f;
+		float throttle = 0.0f;
+		float volume = 0.0f;
+		float left = 0.0f;          // pan gains
+		float right = 0.0f;
+		float noise = 0.0f;         // low passed noise
+		uint32 noise_state = 1;
+		uint32 generation = 0;
+	};
+
+	float Sine(uint32 phase) const;
+	void MixVoice(Voice& voice, const Target& target, float* out, unsigned int frames);
+
+private:
+	int sample_rate;
+	float glide;                    // one pole coefficient of the parameter glide
+	float sine[1 << ENGINE_SINE_BITS];
+	Target targets[ENGINE_MAX_VOICES];
+	Voice voices[ENGINE_MAX_VOICES];
+};
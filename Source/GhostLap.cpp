@@ -0,0 +1,176 @@
+#include "GhostLap.h"
+
+#include <math.h>
+#include <utility>
+
+static const float two_pi = 6.28318530717958647692f;
+
+GhostLap::GhostLap()
+{
+	Clear();
+}
+
+GhostLap::~GhostLap()
+{
+}
+
+void GhostLap::Clear()
+{
+	recording = Stream();
+	best = Stream();
+	last = Pose();
+	Rewind();
+}
+
+void GhostLap::BeginLap()
+{
+	recording.data.clear();
+	recording.ticks = 0;
+	recording.lap_time = 0.0f;
+	recording.overflow = false;
+	last = Pose();
+}
+
+void GhostLap::Record(float x, float y, float angle)
+{
+	if (recording.overflow) return;
+
+	Pose pose;
+	pose.x = (int)lroundf(x * GHOST_POSITION_STEPS);
+	pose.y = (int)lroundf(y * GHOST_POSITION_STEPS);
+	pose.angle = (int)lroundf(angle * (GHOST_ANGLE_STEPS / two_pi)) & (GHOST_ANGLE_STEPS - 1);
+
+	Write(recording.data, pose.x - last.x);
+	Write(recording.data, pose.y - last.y);
+	// Shortest way round, the heading wraps
+	Write(recording.data, (short)(pose.angle - last.angle));
+
+	last = pose;
+	recording.ticks++;
+
+	if (recording.data.size() > GHOST_MAX_BYTES) recording.overflow = true;
+}
+
+int GhostLap::GetRecordedTicks() const
+{
+	return recording.ticks;
+}
+
+bool GhostLap::EndLap(float lap_time)
+{
+	if (recording.overflow || recording.ticks == 0) return false;
+	if (HasBest() && lap_time >= best.lap_time) return false;
+
+	recording.lap_time = lap_time;
+	std::swap(best, recording);
+	Rewind();
+
+	return true;
+}
+
+bool GhostLap::HasBest() const
+{
+	return best.ticks > 0;
+}
+
+float GhostLap::GetBestTime() const
+{
+	return best.lap_time;
+}
+
+int GhostLap::GetBestTicks() const
+{
+	return best.ticks;
+}
+
+int GhostLap::GetBestBytes() const
+{
+	return (int)best.data.size();
+}
+
+bool GhostLap::Sample(float tick, float& x, float& y, float& angle)
+{
+	if (!HasBest()) return false;
+
+	if (tick < 0.0f) tick = 0.0f;
+	if (tick > (float)(best.ticks - 1)) tick = (float)(best.ticks - 1);
+
+	// Going back means a new lap started, decode again from the first tick
+	int index = (int)tick;
+	if (index < cursor_tick) Rewind();
+	if (cursor_tick < 0) Advance();
+	while (cursor_tick < index) Advance();
+
+	float t = tick - (float)index;
+	int turn = (short)(next_pose.angle - cursor_pose.angle);
+
+	x = (cursor_pose.x + (next_pose.x - cursor_pose.x) * t) / GHOST_POSITION_STEPS;
+	y = (cursor_pose.y + (next_pose.y - cursor_pose.y) * t) / GHOST_POSITION_STEPS;
+	angle = (cursor_pose.angle + turn * t) * (two_pi / GHOST_ANGLE_STEPS);
+
+	return true;
+}
+
+void GhostLap::Rewind()
+{
+	cursor_tick = -1;
+	cursor_offset = 0;
+	cursor_pose = Pose();
+	next_pose = Pose();
+}
+
+void GhostLap::Advance()
+{
+	// First call after Rewind() decodes tick 0, the rest step to the next tick
+	if (cursor_tick < 0)
+	{
+		Decode(cursor_offset, cursor_pose);
+		next_pose = cursor_pose;
+	}
+	else
+	{
+		cursor_pose = next_pose;
+	}
+	cursor_tick++;
+
+	// The last tick has no next one, it holds still
+	if (!Decode(cursor_offset, next_pose)) next_pose = cursor_pose;
+}
+
+bool GhostLap::Decode(size_t& offset, Pose& pose) const
+{
+	if (offset >= best.data.size()) return false;
+
+	pose.x += Read(best.data, offset);
+	pose.y += Read(best.data, offset);
+	pose.angle = (pose.angle + Read(best.data, offset)) & (GHOST_ANGLE_STEPS - 1);
+
+	return true;
+}
+
+void GhostLap::Write(std::vector<uchar>& data, int value)
+{
+	// Zigzag: small negative deltas stay small
+	uint32 v = ((uint32)value << 1) ^ (uint32)(value >> 31);
+	while (v >= 0x80)
+	{
+		data.push_back((uchar)(v | 0x80));
+		v >>= 7;
+	}
+	data.push_back((uchar)v);
+}
+
+int GhostLap::Read(const std::vector<uchar>& data, size_t& offset)
+{
+	uint32 v = 0;
+	int shift = 0;
+	while (offset < data.size())
+	{
+		uchar b = data[offset++];
+		v |= (uint32)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0) break;
+		shift += 7;
+	}
+
+	return (int)(v >> 1) ^ -(int)(v & 1);
+}
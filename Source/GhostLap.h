@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <vector>
+
+#define GHOST_POSITION_STEPS 8.0f       // quantization, steps per map pixel
+#define GHOST_ANGLE_STEPS 65536         // quantization, steps per turn
+#define GHOST_MAX_BYTES (100 * 1024)    // a lap that needs more is dropped
+
+// Best lap of a car as a trajectory: one pose per simulation tick, quantized and
+// stored as the difference with the previous one (zigzag varints, most ticks are
+// 4-5 bytes). The current lap is recorded while the best one plays back as a ghost,
+// plain data with no physics body. Playback keeps a cursor into the stream, so
+// following the lap costs one or two decoded samples per frame
+class GhostLap
+{
+public:
+	GhostLap();
+	~GhostLap();
+
+	// Forget the best lap too
+	void Clear();
+
+	// Recording, one Record() per tick of the lap
+	void BeginLap();
+	void Record(float x, float y, float angle);
+	int GetRecordedTicks() const;
+
+	// Lap finished in lap_time: it becomes the ghost if it beats the best one
+	bool EndLap(float lap_time);
+
+	bool HasBest() const;
+	float GetBestTime() const;
+	int GetBestTicks() const;
+	int GetBestBytes() const;
+
+	// Pose of the best lap tick ticks after its start, fractions interpolate
+	// between two ticks. Cheap when tick moves forward a little every call
+	bool Sample(float tick, float& x, float& y, float& angle);
+
+private:
+	struct Pose
+	{
+		int x = 0;
+		int y = 0;
+		int angle = 0;
+	};
+
+	struct Stream
+	{
+		std::vector<uchar> data;
+		int ticks = 0;
+		float lap_time = 0.0f;
+		bool overflow = false;
+	};
+
+	static void Write(std::vector<uchar>& data, int value);
+	static int Read(const std::vector<uchar>& data, size_t& offset);
+
+	void Rewind();
+	void Advance();
+	bool Decode(size_t& offset, Pose& pose) const;
+
+private:
+	Stream recording;
+	Stream best;
+	Pose last;                  // last recorded pose, deltas are against it
+
+	// Playback cursor on best: pose of cursor_tick and the one after it
+	int cursor_tick;
+	size_t cursor_offset;       // first byte after next_pose
+	Pose cursor_pose;
+	Pose next_pose;
+};
@@ -2,9 +2,10 @@
 
 #include "raylib.h"
 
+#include <stdint.h>
 #include <stdio.h>
 
-#define LOG(format, ...) log(__FILE__, __LINE__, format, __VA_ARGS__);
+#define LOG(format, ...) log(__FILE__, __LINE__, format, ##__VA_ARGS__);
 
 void log(const char file[], int line, const char* format, ...);
 
@@ -18,8 +19,8 @@ void log(const char file[], int line, const char* format, ...);
 #define TO_BOOL( a )  ( (a != 0) ? true : false )
 
 typedef unsigned int uint;
-typedef unsigned __int32 uint32;
-typedef unsigned __int64 uint64;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
 typedef unsigned char uchar;
 
 enum update_status
@@ -38,4 +39,6 @@ enum update_status
 #define WIN_BORDERLESS		false
 #define WIN_FULLSCREEN_DESKTOP false
 #define VSYNC				true
+#define FIXED_TIMESTEP		(1.0f / 60.0f)	// simulation tick, seconds
+#define MAX_FRAME_TIME		0.25f			// longest frame the simulation catches up on
 #define TITLE "Physics 2D Playground"
\ No newline at end of file
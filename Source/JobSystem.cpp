@@ -0,0 +1,201 @@
+#include "JobSystem.h"
+#include "Trace.h"
+
+// Queue of the running thread, 0 for the main thread and any thread not from the pool
+static thread_local int thread_queue = 0;
+
+JobSystem::JobSystem()
+{
+	queues = nullptr;
+	queue_count = 0;
+	running = false;
+	queued = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	CleanUp();
+}
+
+bool JobSystem::Init(int worker_count)
+{
+	CleanUp();
+
+	if (worker_count < 0)
+	{
+		int hardware = (int)std::thread::hardware_concurrency();
+		worker_count = hardware > 1 ? hardware - 1 : 0;
+	}
+	if (worker_count > JOBS_MAX_WORKERS) worker_count = JOBS_MAX_WORKERS;
+
+	queue_count = worker_count + 1;
+	queues = new Queue[queue_count];
+	running = true;
+
+	for (int i = 1; i < queue_count; ++i)
+		threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+	return true;
+}
+
+void JobSystem::CleanUp()
+{
+	if (queues == nullptr) return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		running = false;
+	}
+	wake.notify_all();
+
+	for (std::thread& thread : threads)
+		thread.join();
+	threads.clear();
+
+	delete[] queues;
+	queues = nullptr;
+	queue_count = 0;
+	queued = 0;
+}
+
+int JobSystem::GetThreadCount() const
+{
+	return queue_count > 0 ? queue_count : 1;
+}
+
+void JobSystem::Schedule(std::function<void()> job, JobCounter& counter)
+{
+	counter++;
+
+	// Not initialized: nobody else would run it
+	if (queues == nullptr)
+	{
+		job();
+		counter--;
+		return;
+	}
+
+	Queue& queue = queues[thread_queue];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(Job{ std::move(job), &counter });
+	}
+	queued++;
+
+	// Taking the lock orders this with a worker checking queued before it sleeps
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	wake.notify_one();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	while (counter > 0)
+	{
+		if (!RunOne(thread_queue))
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::RunPending()
+{
+	if (queues == nullptr) return false;
+	return RunOne(thread_queue);
+}
+
+void JobSystem::ParallelFor(int count, int grain, const std::function<void(int, int)>& job)
+{
+	if (count <= 0) return;
+	if (grain < 1) grain = 1;
+
+	// A few pieces per thread, so the ones that finish first steal what is left
+	int pieces = (count + grain - 1) / grain;
+	if (pieces > GetThreadCount() * 4) pieces = GetThreadCount() * 4;
+
+	if (pieces <= 1)
+	{
+		job(0, count);
+		return;
+	}
+
+	JobCounter counter(0);
+	for (int i = 1; i < pieces; ++i)
+	{
+		int first = (int)((long long)count * i / pieces);
+		int last = (int)((long long)count * (i + 1) / pieces);
+		Schedule([&job, first, last]() { job(first, last); }, counter);
+	}
+
+	// First piece on this thread, then help with the rest
+	{
+		TRACE_SCOPE("Job");
+		job(0, (int)((long long)count / pieces));
+	}
+	Wait(counter);
+}
+
+void JobSystem::WorkerLoop(int index)
+{
+	thread_queue = index;
+	TraceThreadName("Worker");
+
+	while (running)
+	{
+		if (RunOne(index)) continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake.wait(lock, [this]() { return queued > 0 || !running; });
+	}
+}
+
+bool JobSystem::RunOne(int index)
+{
+	if (queues == nullptr) return false;
+
+	Job job;
+	if (!Pop(index, job) && !Steal(index, job)) return false;
+
+	{
+		TRACE_SCOPE("Job");
+		job.function();
+	}
+	(*job.counter)--;
+
+	return true;
+}
+
+bool JobSystem::Pop(int index, Job& job)
+{
+	Queue& queue = queues[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.jobs.empty()) return false;
+
+	// Newest first, its data is the most likely to still be in cache
+	job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	queued--;
+
+	return true;
+}
+
+bool JobSystem::Steal(int thief, Job& job)
+{
+	for (int i = 1; i < queue_count; ++i)
+	{
+		Queue& queue = queues[(thief + i) % queue_count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.jobs.empty()) continue;
+
+		// Oldest from the victim, the end its owner is not working on
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		queued--;
+
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define JOBS_MAX_WORKERS 64
+
+typedef std::atomic<int> JobCounter;
+
+// Small work stealing job system. Every thread owns a queue: it pushes and pops
+// its own jobs at the back, and when it runs dry it steals from the front of the
+// others'. The thread that waits on a counter runs jobs meanwhile instead of
+// blocking, so the main thread is one more worker (queue 0).
+// Jobs must not touch raylib or Box2D: hand the results back to the main thread
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	// worker_count threads besides the main one, negative for one per extra hardware thread
+	bool Init(int worker_count = -1);
+	void CleanUp();
+
+	// Threads that run jobs, the main one included
+	int GetThreadCount() const;
+
+	// Queue a job, counter is incremented now and decremented when the job is done
+	void Schedule(std::function<void()> job, JobCounter& counter);
+
+	// Help with pending jobs until counter drops to 0
+	void Wait(const JobCounter& counter);
+
+	// Run one pending job on the calling thread, false if there was none. Lets the
+	// main thread make progress on background jobs between frames with no workers
+	bool RunPending();
+
+	// job(first, last) over [first, last) ranges that split [0, count) in pieces of
+	// at least grain items, returns when all are done. Runs inline when one piece is enough
+	void ParallelFor(int count, int grain, const std::function<void(int, int)>& job);
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+	};
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void WorkerLoop(int index);
+	bool RunOne(int index);
+	bool Pop(int index, Job& job);
+	bool Steal(int thief, Job& job);
+
+private:
+	std::vector<std::thread> threads;
+	Queue* queues;                  // one per thread, 0 is the main thread's
+	int queue_count;
+
+	std::atomic<bool> running;
+	std::atomic<int> queued;        // jobs waiting in any queue
+
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+};
@@ -0,0 +1,65 @@
+#include "Leaderboard.h"
+
+Leaderboard::Leaderboard()
+{
+}
+
+Leaderboard::~Leaderboard()
+{
+}
+
+void Leaderboard::Reset(int car_count)
+{
+	order.resize(car_count);
+	positions.resize(car_count);
+	distances.assign(car_count, 0.0f);
+
+	for (int i = 0; i < car_count; ++i)
+	{
+		order[i] = i;
+		positions[i] = i;
+	}
+}
+
+void Leaderboard::SetDistance(int car, float distance)
+{
+	distances[car] = distance;
+}
+
+void Leaderboard::Sort()
+{
+	int count = (int)order.size();
+
+	// Stable, ties keep the previous order so positions do not flicker
+	for (int i = 1; i < count; ++i)
+	{
+		int car = order[i];
+		float distance = distances[car];
+
+		int j = i - 1;
+		while (j >= 0 && distances[order[j]] < distance)
+		{
+			order[j + 1] = order[j];
+			--j;
+		}
+		order[j + 1] = car;
+	}
+
+	for (int i = 0; i < count; ++i)
+		positions[order[i]] = i;
+}
+
+int Leaderboard::GetCarCount() const
+{
+	return (int)order.size();
+}
+
+int Leaderboard::GetCar(int position) const
+{
+	return order[position];
+}
+
+int Leaderboard::GetPosition(int car) const
+{
+	return positions[car];
+}
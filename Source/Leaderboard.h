@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+// Live race order. Cars barely overtake each other between ticks, so the order
+// from the last tick is kept and repaired with an insertion sort: linear on an
+// almost sorted field, no allocation after Reset()
+class Leaderboard
+{
+public:
+	Leaderboard();
+	~Leaderboard();
+
+	void Reset(int car_count);
+
+	// Race distance of a car (laps included), the bigger the better
+	void SetDistance(int car, float distance);
+	void Sort();
+
+	int GetCarCount() const;
+	int GetCar(int position) const;        // 0 is the leader
+	int GetPosition(int car) const;
+
+private:
+	std::vector<int> order;                // position -> car
+	std::vector<int> positions;            // car -> position
+	std::vector<float> distances;          // by car
+};
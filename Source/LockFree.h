@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <atomic>
+
+// Single producer, single consumer ring of CAPACITY items (a power of two).
+// Push() only from the producer thread and Pop() only from the consumer one;
+// neither ever blocks or allocates, a full queue refuses the item
+template <typename T, uint32 CAPACITY>
+class SpscQueue
+{
+	static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+	bool Push(const T& item)
+	{
+		uint32 tail = write.load(std::memory_order_relaxed);
+		if (tail - read.load(std::memory_order_acquire) == CAPACITY) return false;
+
+		items[tail & (CAPACITY - 1)] = item;
+		write.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& item)
+	{
+		uint32 head = read.load(std::memory_order_relaxed);
+		if (head == write.load(std::memory_order_acquire)) return false;
+
+		item = items[head & (CAPACITY - 1)];
+		read.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T items[CAPACITY];
+	alignas(64) std::atomic<uint32> write{ 0 };    // next slot the producer fills
+	alignas(64) std::atomic<uint32> read{ 0 };     // next slot the consumer takes
+};
+
+// Latest value of a state one thread writes and another reads, without locks:
+// the writer fills Back() and publishes it, the reader picks the newest one up
+// with Update() and reads Front(). Each of the three copies belongs to one side
+// at a time, values published while the reader is busy are skipped, not queued
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Writer
+	T& Back()
+	{
+		return buffers[back];
+	}
+
+	void Publish()
+	{
+		back = middle.exchange(back | fresh, std::memory_order_acq_rel) & index;
+	}
+
+	// Reader: true if a newer value was picked up
+	bool Update()
+	{
+		if ((middle.load(std::memory_order_relaxed) & fresh) == 0) return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & index;
+		return true;
+	}
+
+	const T& Front() const
+	{
+		return buffers[front];
+	}
+
+private:
+	static const int index = 3;     // low bits of middle, the buffer
+	static const int fresh = 4;     // published and not read yet
+
+	T buffers[3];
+	int back = 0;
+	int front = 1;
+	std::atomic<int> middle{ 2 };
+};
@@ -1,16 +1,16 @@
-#pragma once
-
 #include "Globals.h"
 
+#include <stdarg.h>
+
 void log(const char file[], int line, const char* format, ...)
 {
 	static char tmp_string[4096];
-	static char tmp_string2[4096];
+	static char tmp_string2[4096 + 512];
 	static va_list  ap;
 
 	// Construct the string from variable arguments
 	va_start(ap, format);
-	vsprintf_s(tmp_string, 4096, format, ap);
+	vsnprintf(tmp_string, 4096, format, ap);
 	va_end(ap);
-	sprintf_s(tmp_string2, 4096, "\n%s(%d) : %s", file, line, tmp_string);
+	snprintf(tmp_string2, sizeof(tmp_string2), "\n%s(%d) : %s", file, line, tmp_string);
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "Application.h"
 #include "Globals.h"
+#include "Trace.h"
 
 #include "raylib.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <chrono>
 
 enum main_states
 {
@@ -19,12 +22,52 @@ enum main_states
 
 int main(int argc, char ** argv)
 {
-	SetTargetFPS(30);
+	// --headless: simulation only, no window / GPU / audio, runs as fast as possible
+	// --ticks N: stop after N simulation ticks
+	// --workers N: job system threads besides the main one (default one per extra core)
+	// --seed N: race seed, the same seed replays the same AI decisions (default from the clock)
+	// --cars N: race N AI cars spread around the lap instead of the 10 car grid
+	// --record FILE: save the seed and the player's controls of the race
+	// --replay FILE: drive the player from a recording (with --headless: re-simulate it and check it stays in sync)
+	// --profile FILE: dump the last frame timings on exit, Chrome trace if FILE ends in .json, CSV otherwise
+	// --trace: record every event from startup to exit into trace.json (chrome://tracing, Perfetto)
+	// Built against raylib with no window backend (CMake headless targets): always headless
+#ifdef HEADLESS_ONLY
+	bool headless = true;
+#else
+	bool headless = false;
+#endif
+	uint64 tick_limit = 0;
+	int workers = -1;
+	uint64 seed = 0;
+	int car_count = 0;
+	const char* record_path = NULL;
+	const char* replay_path = NULL;
+	const char* profile_path = NULL;
+	bool trace = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--headless") == 0) headless = true;
+		else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) tick_limit = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--cars") == 0 && i + 1 < argc) car_count = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) record_path = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay_path = argv[++i];
+		else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) profile_path = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0) trace = true;
+	}
+
+	// Before the Application exists, so startup and asset loading are in the trace
+	if (trace) TraceStart("trace.json");
+
+	// No frame cap: VSYNC paces rendering and the simulation runs on its own fixed tick
 	LOG("Starting game '%s'...", TITLE);
 
 	int main_return = EXIT_FAILURE;
 	main_states state = MAIN_CREATION;
 	Application* App = NULL;
+	std::chrono::steady_clock::time_point update_start;
 
 	while (state != MAIN_EXIT)
 	{
@@ -33,7 +76,14 @@ int main(int argc, char ** argv)
 		case MAIN_CREATION:
 
 			LOG("-------------- Application Creation --------------");
-			App = new Application();
+			App = new Application(headless);
+			App->SetTickLimit(tick_limit);
+			App->SetWorkerCount(workers);
+			App->SetSeed(seed);
+			App->SetCarCount(car_count);
+			App->SetRecordPath(record_path);
+			App->SetReplayPath(replay_path);
+			App->SetProfilePath(profile_path);
 			state = MAIN_START;
 			break;
 
@@ -48,6 +98,7 @@ int main(int argc, char ** argv)
 			else
 			{
 				state = MAIN_UPDATE;
+				update_start = std::chrono::steady_clock::now();
 				LOG("-------------- Application Update --------------");
 			}
 
@@ -80,12 +131,22 @@ int main(int argc, char ** argv)
 
 			state = MAIN_EXIT;
 
+			if (headless)
+			{
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+				printf("Simulated %llu ticks (%.1f s) in %.2f s, %.0f ticks/s\n",
+					(unsigned long long)App->GetTickCount(), App->GetTickCount() * FIXED_TIMESTEP, seconds, App->GetTickCount() / (seconds > 0.0 ? seconds : 1.0));
+			}
+
 			break;
 
+		default:
+			break;
 		}
 	}
 
 	delete App;
+	TraceStop();
 	LOG("Exiting game '%s'...\n", TITLE);
 	return main_return;
 }
\ No newline at end of file
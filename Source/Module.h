@@ -13,7 +13,7 @@ private :
 public:
 	Application* App;
 
-	Module(Application* parent, bool start_enabled = true) : App(parent), enabled(start_enabled)
+	Module(Application* parent, bool start_enabled = true) : enabled(start_enabled), App(parent)
 	{}
 
 	virtual ~Module()
@@ -57,6 +57,13 @@ public:
 		return UPDATE_CONTINUE;
 	}
 
+	// Called at a fixed rate (FIXED_TIMESTEP), zero or more times per frame
+	// between PreUpdate() and Update(). Simulation lives here, drawing does not
+	virtual update_status FixedUpdate(float /*dt*/)
+	{
+		return UPDATE_CONTINUE;
+	}
+
 	virtual update_status Update()
 	{
 		return UPDATE_CONTINUE;
@@ -72,7 +79,7 @@ public:
 		return true; 
 	}
 
-	virtual void OnCollision(PhysBody* bodyA, PhysBody* bodyB)
+	virtual void OnCollision(PhysBody* /*bodyA*/, PhysBody* /*bodyB*/)
 	{
 	}
 };
\ No newline at end of file
@@ -1,21 +1,48 @@
 #include "Globals.h"
 #include "Application.h"
 #include "ModuleAudio.h"
+#include "Trace.h"
 
 #include "raylib.h"
 
+#include <chrono>
+#include <string.h>
+
 // Default volumes
 static const float MUSIC_DEFAULT_VOLUME =0.1f;
-static const float MOTOR_DEFAULT_VOLUME =0.6f;
 static const float FX_DEFAULT_VOLUME =0.8f;
 
+// Engine stream: 32 bit float stereo, filled by the synth on raylib's mixing thread
+static const int ENGINE_SAMPLE_RATE =44100;
+
+// Positional sounds: half volume this far from the listener, fully to one side
+// this far across, not mixed below the minimum volume (world pixels)
+static const float AUDIO_HEARING_DISTANCE =700.0f;
+static const float AUDIO_PAN_DISTANCE =SCREEN_WIDTH *0.5f;
+static const float AUDIO_MIN_VOLUME =0.02f;
+
+// Audio thread pass: far shorter than a music stream buffer, so a refill is never late
+static const std::chrono::milliseconds AUDIO_THREAD_PERIOD(5);
+
+// raylib callbacks carry no user data, the synth of the (only) audio module
+static EngineSynth* engine_synth = NULL;
+
+static void EngineStreamCallback(void* buffer, unsigned int frames)
+{
+	engine_synth->Mix((float*)buffer, frames);
+}
+
 ModuleAudio::ModuleAudio(Application* app, bool start_enabled) : Module(app, start_enabled)
 {
 	fx_count =0;
-	music = Music{0};
-	// motorMusic declared in header; initialize here
-	motorMusic = Music{0};
-	motor_playing = false;
+	music = Music{};
+	engine_stream = AudioStream{};
+	for (int v =0; v < MAX_FX_VOICES; v++)
+	{
+		fx_aliases[v] = Sound{};
+		fx_alias_sound[v] = -1;
+		fx_voice_owner[v] = -1;
+	}
 }
 
 // Destructor
@@ -29,10 +56,35 @@ bool ModuleAudio::Init()
 	LOG("Loading Audio Mixer");
 	bool ret = true;
 
+	// Disabled (headless): no device, every call below is a no-op
+	if (IsEnabled() == false)
+		return ret;
+
 	LOG("Loading raylib audio system");
 
 	InitAudioDevice();
 
+	engine_voices.Init(ENGINE_MAX_VOICES, AUDIO_MIN_VOLUME);
+	fx_voices.Init(MAX_FX_VOICES, AUDIO_MIN_VOLUME);
+	fx_emitters.resize(MAX_FX_EMITTERS);
+
+	// Engines: one stream for every motor, silent until the game sets them
+	engines.Init(ENGINE_SAMPLE_RATE);
+	engine_synth = &engines;
+	engine_stream = LoadAudioStream(ENGINE_SAMPLE_RATE, 32, 2);
+	if (IsAudioStreamReady(engine_stream))
+	{
+		SetAudioStreamCallback(engine_stream, EngineStreamCallback);
+		PlayAudioStream(engine_stream);
+	}
+	else
+	{
+		LOG("Cannot open the engine sound stream");
+	}
+
+	running = true;
+	audio_thread = std::thread(&ModuleAudio::AudioLoop, this);
+
 	return ret;
 }
 
@@ -41,6 +93,21 @@ bool ModuleAudio::CleanUp()
 {
 	LOG("Freeing sound FX, closing Mixer and Audio subsystem");
 
+	// Audio thread first, everything below is back on this thread
+	if (audio_thread.joinable())
+	{
+		running = false;
+		audio_thread.join();
+	}
+
+	// Unload FX voices, then the sounds they share
+	for (int v =0; v < MAX_FX_VOICES; v++)
+	{
+		if (fx_alias_sound[v] >= 0) UnloadSoundAlias(fx_aliases[v]);
+		fx_alias_sound[v] = -1;
+		fx_voice_owner[v] = -1;
+	}
+
 	// Unload sounds
 	for (unsigned int i =0; i < fx_count; i++)
 	{
@@ -48,56 +115,244 @@ bool ModuleAudio::CleanUp()
 	}
 
 	// Unload music
-	if (IsMusicReady(music))
+	UnloadMusic();
+
+	// Engines
+	if (IsAudioStreamReady(engine_stream))
 	{
-		StopMusicStream(music);
-		UnloadMusicStream(music);
-		music = Music{0};
+		StopAudioStream(engine_stream);
+		UnloadAudioStream(engine_stream);
+		engine_stream = AudioStream{};
 	}
+	engine_synth = NULL;
+
+	if (IsAudioDeviceReady())
+		CloseAudioDevice();
+
+	return true;
+}
+
+// A full queue drops the command, the game never waits for the audio thread
+bool ModuleAudio::Queue(const AudioCommand& command)
+{
+	if (commands.Push(command)) return true;
 
-	// Unload motor music if any
-	if (IsMusicReady(motorMusic))
+	LOG("Audio command queue full, command dropped");
+	return false;
+}
+
+// Play a music file, loaded and started by the audio thread
+bool ModuleAudio::PlayMusic(const char* path, float /*fade_time*/)
+{
+	if (IsEnabled() == false)
+		return false;
+
+	AudioCommand command;
+	command.type = AUDIO_COMMAND_PLAY_MUSIC;
+	strncpy(command.path, path, AUDIO_PATH_LENGTH - 1);
+	return Queue(command);
+}
+
+// Stop current music and unload
+bool ModuleAudio::StopMusic()
+{
+	if (IsEnabled() == false)
+		return false;
+
+	AudioCommand command;
+	command.type = AUDIO_COMMAND_STOP_MUSIC;
+	return Queue(command);
+}
+
+void ModuleAudio::SetListener(float x, float y)
+{
+	world.listener_x = x;
+	world.listener_y = y;
+}
+
+void ModuleAudio::SetEngineCount(int count)
+{
+	if (IsEnabled() == false) return;
+	world.engines.resize(count);
+}
+
+void ModuleAudio::SetEngine(int engine, float x, float y, float rpm, float throttle, float gain, int priority)
+{
+	if (IsEnabled() == false || engine < 0 || engine >= (int)world.engines.size()) return;
+
+	Engine& params = world.engines[engine];
+	params.x = x;
+	params.y = y;
+	params.rpm = rpm;
+	params.throttle = throttle;
+	params.gain = gain;
+	params.priority = priority;
+}
+
+// No engines until the game sets them again, the voices fade out
+void ModuleAudio::SilenceEngines()
+{
+	if (IsEnabled() == false) return;
+	world.engines.clear();
+}
+
+// The frame's listener and engines go to the audio thread as a whole
+update_status ModuleAudio::PostUpdate()
+{
+	if (IsEnabled())
 	{
-		StopMusicStream(motorMusic);
-		UnloadMusicStream(motorMusic);
-		motorMusic = Music{0};
-		motor_playing = false;
+		published.Back() = world;
+		published.Publish();
 	}
+	return UPDATE_CONTINUE;
+}
 
-	CloseAudioDevice();
+// Load WAV
+unsigned int ModuleAudio::LoadFx(const char* path)
+{
+	if (IsEnabled() == false)
+		return 0;
 
-	return true;
+	TRACE_SCOPE("LoadSound", path);
+	Wave wave = LoadWave(path);
+	if (wave.data == NULL)
+	{
+		LOG("Cannot load sound: %s", path);
+		return 0;
+	}
+
+	unsigned int ret = LoadFx(wave);
+	UnloadWave(wave);
+
+	return ret;
 }
 
-// Play a music file
-bool ModuleAudio::PlayMusic(const char* path, float fade_time)
+// Decoded WAV
+unsigned int ModuleAudio::LoadFx(const Wave& wave)
 {
 	if (IsEnabled() == false)
+		return 0;
+
+	unsigned int ret =0;
+
+	Sound sound = LoadSoundFromWave(wave);
+
+	if (sound.stream.buffer == NULL || fx_count >= MAX_SOUNDS)
+	{
+		LOG("Cannot load sound: no data or too many sounds");
+		UnloadSound(sound);
+	}
+	else
+	{
+		fx[fx_count] = sound;
+		ret = fx_count++;
+		// set default fx volume
+		SetSoundVolume(fx[ret], FX_DEFAULT_VOLUME);
+	}
+
+	return ret;
+}
+
+// Play WAV, centred
+bool ModuleAudio::PlayFx(unsigned int id, int /*repeat*/, int priority)
+{
+	if (IsEnabled() == false || id >= fx_count)
+	{
 		return false;
+	}
 
-	// Stop any currently playing music and unload it
-	if (IsMusicReady(music))
+	AudioCommand command;
+	command.type = AUDIO_COMMAND_PLAY_FX;
+	command.fx = (int)id;
+	command.priority = priority;
+	return Queue(command);
+}
+
+// Play WAV at a world position
+bool ModuleAudio::PlayFxAt(unsigned int id, float x, float y, int priority)
+{
+	if (IsEnabled() == false || id >= fx_count)
 	{
-		StopMusicStream(music);
-		UnloadMusicStream(music);
-		music = Music{0};
+		return false;
 	}
 
-	music = LoadMusicStream(path);
+	AudioCommand command;
+	command.type = AUDIO_COMMAND_PLAY_FX;
+	command.fx = (int)id;
+	command.priority = priority;
+	command.positional = true;
+	command.x = x;
+	command.y = y;
+	return Queue(command);
+}
+
+// ---------------------------------------------------------------------
+// Audio thread
+// ---------------------------------------------------------------------
+
+void ModuleAudio::AudioLoop()
+{
+	using Clock = std::chrono::steady_clock;
+
+	TraceThreadName("Audio");
+	Clock::time_point last = Clock::now();
+
+	while (running)
+	{
+		Clock::time_point now = Clock::now();
+		float dt = std::chrono::duration<float>(now - last).count();
+		last = now;
+
+		{
+			TRACE_SCOPE("Audio pass");
+
+			AudioCommand command;
+			while (commands.Pop(command)) Execute(command);
+
+			published.Update();
+
+			// Keep streaming music if loaded
+			if (IsMusicReady(music))
+			{
+				TRACE_SCOPE("Music stream");
+				UpdateMusicStream(music);
+			}
+
+			UpdateEngines();
+			UpdateFx(dt);
+		}
+
+		std::this_thread::sleep_until(now + AUDIO_THREAD_PERIOD);
+	}
+}
+
+void ModuleAudio::Execute(const AudioCommand& command)
+{
+	switch (command.type)
+	{
+	case AUDIO_COMMAND_PLAY_MUSIC: StartMusic(command.path); break;
+	case AUDIO_COMMAND_STOP_MUSIC: UnloadMusic(); break;
+	case AUDIO_COMMAND_PLAY_FX: StartFx(command.fx, command.positional, command.x, command.y, command.priority); break;
+	}
+}
+
+void ModuleAudio::StartMusic(const char* path)
+{
+	// Stop any currently playing music and unload it
+	UnloadMusic();
+
+	{
+		TRACE_SCOPE("LoadMusicStream", path);
+		music = LoadMusicStream(path);
+	}
 	if (!IsMusicReady(music))
 	{
 		LOG("Cannot load music: %s", path);
-		return false;
+		return;
 	}
 
-	// ensure music will loop until explicitly stopped (many raylib versions expose this field)
-	// Set it if available
-	#ifdef MUSIC_LOOPING
+	// ensure music will loop until explicitly stopped
 	music.looping = true;
-	#else
-	// try to set looping member anyway; if not present compilers that support it will accept it
-	music.looping = true;
-	#endif
 
 	PlayMusicStream(music);
 	// Kick the stream once so playback starts immediately
@@ -107,118 +362,140 @@ bool ModuleAudio::PlayMusic(const char* path, float fade_time)
 	SetMusicVolume(music, MUSIC_DEFAULT_VOLUME);
 
 	LOG("Successfully started music %s", path);
-
-	return true;
 }
 
-// Stop current music and unload
-bool ModuleAudio::StopMusic()
+void ModuleAudio::UnloadMusic()
 {
-	if (!IsMusicReady(music)) return false;
+	if (!IsMusicReady(music)) return;
 
 	StopMusicStream(music);
 	UnloadMusicStream(music);
-	music = Music{0};
-	return true;
+	music = Music{};
 }
 
-// Play motor sound (loop while W/S is held)
-bool ModuleAudio::PlayMotor(const char* path)
+// Volume and pan of a sound from where it is, centred sounds keep their gain
+void ModuleAudio::Spatialize(bool positional, float x, float y, float gain, float& volume, float& pan) const
 {
-	if (IsEnabled() == false) return false;
-	if (motor_playing) return true;
+	volume = gain;
+	pan = 0.0f;
+	if (!positional) return;
+
+	const AudioWorld& current = published.Front();
+	float dx = x - current.listener_x;
+	float dy = y - current.listener_y;
+	volume = gain / (1.0f + (dx * dx + dy * dy) / (AUDIO_HEARING_DISTANCE * AUDIO_HEARING_DISTANCE));
+	pan = MAX(-1.0f, MIN(dx / AUDIO_PAN_DISTANCE, 1.0f));
+}
 
-	// Stop/unload existing motor music if any
-	if (IsMusicReady(motorMusic))
-	{
-		StopMusicStream(motorMusic);
-		UnloadMusicStream(motorMusic);
-		motorMusic = Music{0};
-	}
+// Engines to voices: the synth only ever mixes ENGINE_MAX_VOICES motors
+void ModuleAudio::UpdateEngines()
+{
+	const std::vector<Engine>& params = published.Front().engines;
+	engine_emitters.resize(params.size());
 
-	motorMusic = LoadMusicStream(path);
-	if (!IsMusicReady(motorMusic))
+	for (size_t e = 0; e < params.size(); ++e)
 	{
-		LOG("Cannot load motor music: %s", path);
-		return false;
+		VoiceEmitter& emitter = engine_emitters[e];
+		emitter.priority = params[e].priority;
+		Spatialize(true, params[e].x, params[e].y, params[e].gain, emitter.volume, emitter.pan);
 	}
 
-	// Request looping
-	motorMusic.looping = true;
-	PlayMusicStream(motorMusic);
-	UpdateMusicStream(motorMusic);
-	// Slightly louder than background but not full
-	SetMusicVolume(motorMusic,0.6f);
-	motor_playing = true;
-	return true;
-}
+	engine_voices.Assign(engine_emitters);
 
-// Stop motor music
-bool ModuleAudio::StopMotor()
-{
-	if (!motor_playing) return false;
-	if (IsMusicReady(motorMusic))
+	for (int v = 0; v < ENGINE_MAX_VOICES; ++v)
 	{
-		StopMusicStream(motorMusic);
-		UnloadMusicStream(motorMusic);
-		motorMusic = Music{0};
+		int owner = engine_voices.GetOwner(v);
+		if (owner < 0)
+		{
+			engines.Silence(v);
+			continue;
+		}
+
+		const VoiceEmitter& emitter = engine_emitters[owner];
+		engines.SetVoice(v, params[owner].rpm, params[owner].throttle, emitter.volume, emitter.pan, emitter.fresh);
 	}
-	motor_playing = false;
-	return true;
+
+	TraceCounter("Engine voices", engine_voices.GetRealCount());
+	TraceCounter("Virtual engines", engine_voices.GetVirtualCount());
 }
 
-// Update music stream each frame
-update_status ModuleAudio::Update()
+// New FX instance, it gets a voice right away if one is free or it outranks one
+void ModuleAudio::StartFx(int id, bool positional, float x, float y, int priority)
 {
-	// Keep streaming music if loaded
-	if (IsMusicReady(music))
+	int slot = -1;
+	for (int i = 0; i < MAX_FX_EMITTERS && slot < 0; i++)
 	{
-		UpdateMusicStream(music);
+		if (fx_instances[i].sound < 0) slot = i;
 	}
-	// Update motor music stream as well
-	if (IsMusicReady(motorMusic))
-	{
-		UpdateMusicStream(motorMusic);
-	}
-	return UPDATE_CONTINUE;
-}
+	if (slot < 0) return;
 
-// Load WAV
-unsigned int ModuleAudio::LoadFx(const char* path)
-{
-	if (IsEnabled() == false)
-		return 0;
+	FxInstance& instance = fx_instances[slot];
+	instance.sound = id;
+	instance.positional = positional;
+	instance.x = x;
+	instance.y = y;
+	instance.time_left = (float)fx[id].frameCount / fx[id].stream.sampleRate;
 
-	unsigned int ret =0;
+	VoiceEmitter& emitter = fx_emitters[slot];
+	emitter = VoiceEmitter();
+	emitter.priority = priority;
+	Spatialize(positional, x, y, 1.0f, emitter.volume, emitter.pan);
 
-	Sound sound = LoadSound(path);
+	AssignFxVoices();
+}
 
-	if (sound.stream.buffer == NULL)
+// FX to voices. A one-shot only starts on the pass it is played: one that
+// loses its voice stays virtual until its length has passed
+void ModuleAudio::AssignFxVoices()
+{
+	fx_voices.Assign(fx_emitters);
+
+	for (int v = 0; v < MAX_FX_VOICES; v++)
 	{
-		LOG("Cannot load sound: %s", path);
-	}
-	else
-	{
-		fx[fx_count] = sound;
-		ret = fx_count++;
-		// set default fx volume
-		SetSoundVolume(fx[ret], FX_DEFAULT_VOLUME);
+		int owner = fx_voices.GetOwner(v);
+		if (owner != fx_voice_owner[v] && fx_voice_owner[v] >= 0) StopSound(fx_aliases[v]);
+		fx_voice_owner[v] = owner;
+		if (owner < 0) continue;
+
+		const FxInstance& instance = fx_instances[owner];
+		const VoiceEmitter& emitter = fx_emitters[owner];
+		if (emitter.fresh && fx_alias_sound[v] != instance.sound)
+		{
+			if (fx_alias_sound[v] >= 0) UnloadSoundAlias(fx_aliases[v]);
+			fx_aliases[v] = LoadSoundAlias(fx[instance.sound]);
+			fx_alias_sound[v] = instance.sound;
+		}
+
+		// raylib pans 1 left .. 0 right
+		SetSoundVolume(fx_aliases[v], FX_DEFAULT_VOLUME * emitter.volume);
+		SetSoundPan(fx_aliases[v], 0.5f - 0.5f * emitter.pan);
+		if (emitter.fresh) PlaySound(fx_aliases[v]);
 	}
 
-	return ret;
+	for (VoiceEmitter& emitter : fx_emitters) emitter.can_start = false;
 }
 
-// Play WAV
-bool ModuleAudio::PlayFx(unsigned int id, int repeat)
+void ModuleAudio::UpdateFx(float dt)
 {
-	if (IsEnabled() == false)
+	for (int i = 0; i < MAX_FX_EMITTERS; i++)
 	{
-		return false;
+		FxInstance& instance = fx_instances[i];
+		VoiceEmitter& emitter = fx_emitters[i];
+		if (instance.sound < 0) continue;
+
+		instance.time_left -= dt;
+		if (instance.time_left <= 0.0f)
+		{
+			instance.sound = -1;
+			emitter.volume = 0.0f;
+			continue;
+		}
+
+		Spatialize(instance.positional, instance.x, instance.y, 1.0f, emitter.volume, emitter.pan);
 	}
 
-	bool ret = false;
-
-	if (id < fx_count) PlaySound(fx[id]);
+	AssignFxVoices();
 
-	return ret;
-}
\ No newline at end of file
+	TraceCounter("FX voices", fx_voices.GetRealCount());
+	TraceCounter("Virtual FX", fx_voices.GetVirtualCount());
+}
@@ -1,10 +1,35 @@
 #pragma once
 
 #include "Module.h"
+#include "EngineSynth.h"
+#include "VoiceManager.h"
+#include "LockFree.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #define MAX_SOUNDS	16
+#define MAX_FX_VOICES	8		// FX mixed at once
+#define MAX_FX_EMITTERS	32		// FX tracked at once, mixed or virtual
 #define DEFAULT_MUSIC_FADE_TIME 2.0f
+#define AUDIO_COMMAND_CAPACITY	256		// commands queued per audio thread pass
+#define AUDIO_PATH_LENGTH	256
+
+// Who keeps a voice when there are not enough: higher first, then the louder
+enum AudioPriority
+{
+	AUDIO_PRIORITY_LOW,
+	AUDIO_PRIORITY_NORMAL,
+	AUDIO_PRIORITY_HIGH,
+	AUDIO_PRIORITY_UI			// HUD, countdown, radio: the world never takes their voice
+};
 
+// Every raylib audio call after Init runs on the audio thread, which refills the
+// music stream, starts the FX and hands out the voices every few milliseconds
+// whatever the frame time. The game thread only queues commands (lock free, never
+// waits) and publishes the listener and engines once per frame, in PostUpdate.
+// The engines themselves are synthesized on raylib's mixing thread (EngineSynth)
 class ModuleAudio : public Module
 {
 public:
@@ -21,24 +46,119 @@ public:
 	// Stop current music
 	bool StopMusic();
 
-	// Play motor sound (loop while W/S is held)
-	bool PlayMotor(const char* path);
-	bool StopMotor();
+	// Listener (the camera centre), world pixels: positional sounds fade with
+	// their distance to it and pan with their side
+	void SetListener(float x, float y);
+
+	// Engine sound: one engine per car, any number. The highest priority, loudest
+	// ones get a synthesized voice (see EngineSynth), the rest are virtual.
+	// rpm and throttle 0..1, gain scales the engine before the distance fade
+	void SetEngineCount(int count);
+	void SetEngine(int engine, float x, float y, float rpm, float throttle, float gain, int priority);
+	void SilenceEngines();
 
 	// Load a sound in memory
 	unsigned int LoadFx(const char* path);
 
-	// Play a previously loaded sound
-	bool PlayFx(unsigned int fx, int repeat = 0);
+	// Same from a wave already decoded (asset loader), the wave stays the caller's
+	unsigned int LoadFx(const Wave& wave);
+
+	// Play a previously loaded sound, centred and at full volume
+	bool PlayFx(unsigned int fx, int repeat = 0, int priority = AUDIO_PRIORITY_UI);
 
-	// Update music stream each frame
-	update_status Update() override;
+	// Play a previously loaded sound at a world position
+	bool PlayFxAt(unsigned int fx, float x, float y, int priority = AUDIO_PRIORITY_NORMAL);
+
+	// Hand this frame's listener and engines to the audio thread
+	update_status PostUpdate() override;
 
 private:
 
-	Music music;
-	Music motorMusic;
-	bool motor_playing = false;
+	struct Engine
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float rpm = 0.0f;
+		float throttle = 0.0f;
+		float gain = 0.0f;
+		int priority = AUDIO_PRIORITY_NORMAL;
+	};
+
+	// Everything positional of a frame, published as a whole
+	struct AudioWorld
+	{
+		float listener_x = 0.0f;
+		float listener_y = 0.0f;
+		std::vector<Engine> engines;
+	};
+
+	enum AudioCommandType
+	{
+		AUDIO_COMMAND_PLAY_MUSIC,
+		AUDIO_COMMAND_STOP_MUSIC,
+		AUDIO_COMMAND_PLAY_FX
+	};
+
+	struct AudioCommand
+	{
+		AudioCommandType type = AUDIO_COMMAND_STOP_MUSIC;
+		int fx = 0;
+		int priority = 0;
+		bool positional = false;
+		float x = 0.0f;
+		float y = 0.0f;
+		char path[AUDIO_PATH_LENGTH] = {};
+	};
+
+	// FX being played, tracked until its length has passed even while virtual
+	struct FxInstance
+	{
+		int sound = -1;				// -1 free slot
+		bool positional = false;
+		float x = 0.0f;
+		float y = 0.0f;
+		float time_left = 0.0f;		// seconds
+	};
+
+	bool Queue(const AudioCommand& command);
+
+	// Audio thread
+	void AudioLoop();
+	void Execute(const AudioCommand& command);
+	void StartMusic(const char* path);
+	void UnloadMusic();
+	void Spatialize(bool positional, float x, float y, float gain, float& volume, float& pan) const;
+	void StartFx(int fx, bool positional, float x, float y, int priority);
+	void AssignFxVoices();
+	void UpdateEngines();
+	void UpdateFx(float dt);
+
+private:
+
+	// Game thread
+	AudioWorld world;							// being filled this frame
+	SpscQueue<AudioCommand, AUDIO_COMMAND_CAPACITY> commands;
+	TripleBuffer<AudioWorld> published;
+	std::thread audio_thread;
+	std::atomic<bool> running{ false };
+
+	// Shared, read only once loaded: fx[i] is written before any command for it
 	Sound fx[MAX_SOUNDS];
 	unsigned int fx_count;
+
+	// Audio thread from here on
+	Music music;
+
+	EngineSynth engines;
+	AudioStream engine_stream;
+	std::vector<VoiceEmitter> engine_emitters;
+	VoiceManager engine_voices;
+
+	// FX voices: a sound alias each (own playback state, shared sample data)
+	FxInstance fx_instances[MAX_FX_EMITTERS];
+	std::vector<VoiceEmitter> fx_emitters;
+	VoiceManager fx_voices;
+	Sound fx_aliases[MAX_FX_VOICES];
+	int fx_alias_sound[MAX_FX_VOICES];		// sound each alias shares, -1 none
+	int fx_voice_owner[MAX_FX_VOICES];		// instance playing on each voice, -1 none
 };
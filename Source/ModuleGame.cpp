@@ -4,6 +4,11 @@
 #include "ModuleAudio.h"
 #include "ModulePhysics.h"
 #include "ModuleRender.h"
+#include "CarTable.h"
+#include "AISteering.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Trace.h"
 #include <vector>
 #include <fstream>
 #include <cstdio>   // snprintf
@@ -12,6 +17,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <cassert>
 
 static Texture2D gFrontCarTexture;
 static Texture2D gFrontCarTextureLeft;
@@ -21,25 +27,22 @@ static Texture2D gFrontCarTextureRight;
 // TIMERS (NO TOCAN EL .H) - Jugador + IAs
 // =====================================================
 static const int kMaxLaps = 3;
+static const int kCarWidth = 90;   // caja fisica del coche, px
+static const int kCarHeight = 40;
 static bool sRaceFinished = false;
-static float sPlayerLapStart = 0.0f;
-static float sPlayerLapCurrent = 0.0f;
-static float sPlayerLapLast = 0.0f;
-static float sPlayerLapBest = 999999.0f;
 static bool sPlayerWon = false;
-static std::vector<float> sAiLapStart;
-static std::vector<float> sAiLapCurrent;
-static std::vector<float> sAiLapLast;
-static std::vector<float> sAiLapBest;
 
 // ===== END GAME STATE =====
 static bool sAiWon = false;
 static float sEndTime = 0.0f;      
 static const float kEndDelay = 3.0f; 
 
-// ===== START COUNTDOWN (frames @30 FPS ->90 frames =3s) =====
-// countdown frames are initially 0; they are set to 90 when player presses ENTER
-static int sStartCountdownFrames = 0;
+// ===== START COUNTDOWN (seconds of simulation) =====
+// countdown is initially 0; it is set to kCountdownTime when player presses ENTER
+static const float kCountdownTime = 3.0f;
+static float sStartCountdown = 0.0f;
+// Simulation clock, advances FIXED_TIMESTEP per tick while racing (lap timers)
+static float sSimTime = 0.0f;
 // Pre-start controls screen flag
 static bool sPreStartScreen = true;
 
@@ -51,385 +54,50 @@ static void FormatTime(float t, char* out, int outSize)
     std::snprintf(out, outSize, "%02d:%05.2f", minutes, seconds);
 }
 
-static void DrawRaceTimesHUD(int lapCount,
-    const std::vector<int>& aiLaps,
-    int numAI)
-{
-    char cur[32], best[32], last[32];
-    FormatTime(sPlayerLapCurrent, cur, 32);
-    FormatTime((sPlayerLapBest >= 999998.0f) ? 0.0f : sPlayerLapBest, best, 32);
-    FormatTime(sPlayerLapLast, last, 32);
-
-    int x = 30;
-    int y = 70;
-
-    DrawText(TextFormat("Vuelta: %d/%d", lapCount, kMaxLaps), x, y, 20, WHITE); y += 22;
-    DrawText(TextFormat("Lap:  %s", cur), x, y, 20, WHITE); y += 22;
-    DrawText(TextFormat("Best: %s", best), x, y, 20, WHITE); y += 22;
-    DrawText(TextFormat("Last: %s", last), x, y, 20, WHITE); y += 28;
-
-    DrawText("IAS (lap | best)", x, y, 18, WHITE); y += 22;
-
-    for (int i = 0; i < numAI; ++i)
-    {
-        char aiBestStr[32];
-        float b = (i < (int)sAiLapBest.size() && sAiLapBest[i] < 999998.0f) ? sAiLapBest[i] : 0.0f;
-        FormatTime(b, aiBestStr, 32);
-
-        int laps = (i < (int)aiLaps.size()) ? aiLaps[i] : 0;
-        DrawText(TextFormat("AI%02d: %d | %s", i + 1, laps, aiBestStr), x, y, 18, WHITE);
-        y += 20;
-
-        if (y > SCREEN_HEIGHT - 40) break;
-    }
-}
-
-// =====================================================================
-// CLASE BASE: cualquier cosa con fsica que se pueda dibujar
-// =====================================================================
-class PhysicEntity
-{
-protected:
-    PhysicEntity(PhysBody* _body, Module* _listener)
-        : body(_body)
-        , listener(_listener)
-    {
-        body->listener = listener;
-    }
-
-public:
-    virtual ~PhysicEntity() = default;
-    virtual void Update() = 0;
-
-public:
-    PhysBody* body = nullptr;
-    Module* listener = nullptr;
-};
-
 // =====================================================================
-// COCHE F1 (jugador o IA)
+// COCHE F1 (jugador o IA): una fila de ModuleGame::cars por coche
 // =====================================================================
-class Box : public PhysicEntity
-{
-public:
-    Box(ModulePhysics* physics, int _x, int _y, Module* _listener,
-        Texture2D bodyTex, Texture2D frontTex,
-        bool ai = false, int _aiId = -1)
-        : PhysicEntity(physics->CreateRectangle(_x, _y, 90, 40), _listener)
-        , bodyTexture(bodyTex)
-        , frontTexture(frontTex)
-        , isAI(ai)
-        , aiId(_aiId)
-    {
-    }
-
-    void Update() override
-    {
-        if (isAI) UpdateAI();
-        else HandleInput();
-
-        UpdateMovement();
-        DrawCar();
-    }
-
-    bool IsAI() const { return isAI; }
-
-private:
-    int aiId = -1;
-
-    // ---------------------- INPUT WASD (JUGADOR) ----------------------
-    void HandleInput()
-    {
-        forwardInput = 0.0f;
-        steeringInput = 0.0f;
-
-        // Space hard brake
-        if (IsKeyDown(KEY_SPACE))
-            hardBrake = true;
-        else
-            hardBrake = false;
-
-        if (IsKeyDown(KEY_W)) forwardInput = 1.1f;
-        if (IsKeyDown(KEY_S)) forwardInput = -1.1f;
-        if (IsKeyDown(KEY_A)) steeringInput = -1.0f;
-        if (IsKeyDown(KEY_D)) steeringInput = 1.0f;
-
-        // If hard braking, cancel forward input so we don't accelerate
-        if (hardBrake)
-            forwardInput = 0.0f;
-    }
-
-    // ---------------------- IA SIMPLE: seguir checkP1->checkP2->... ----------------------
-    void UpdateAI()
-    {
-        steeringInput = 0.0f;
-
-        // Small random chance (approx 1%) the AI will slow down / reverse
-        int r = std::rand() % 100 + 1; // 1..100
-        if (r == 1)
-            forwardInput = -10.0f;
-        else
-            forwardInput = 1.0f;
-
-        int x, y;
-        body->GetPhysicPosition(x, y);
-
-        ModuleGame* game = (ModuleGame*)listener;
-
-        PhysBody* target = nullptr;
-        if (!game->checkpoints.empty())
-        {
-            int idx = 0;
-            if (aiId >= 0 && aiId < (int)game->aiNextCP.size())
-                idx = game->aiNextCP[aiId];
-            if (idx < 0) idx = 0;
-            if (idx >= (int)game->checkpoints.size()) idx = 0;
-            target = game->checkpoints[idx];
-        }
-        if (target == nullptr) return;
-
-        int tx, ty;
-        target->GetPhysicPosition(tx, ty);
-
-        float dx = (float)(tx - x);
-        float dy = (float)(ty - y);
-
-        float targetAngle = atan2f(dy, dx);
-        float currentAngle = body->GetRotation();
-
-        float diff = targetAngle - currentAngle;
-
-        // Normalizar a (-PI, PI)
-        while (diff > PI)  diff -= 2.0f * PI;
-        while (diff < -PI) diff += 2.0f * PI;
-
-        if (diff > 0.08f) steeringInput = 0.6f;
-        else if (diff < -0.08f) steeringInput = -0.6f;
-        else steeringInput = 0.0f;
-    }
-
-    // ---------------- VELOCIDAD / FRENADO / GIRO ----------------
-    void UpdateMovement()
-    {
-        float angle = body->GetRotation();
-        b2Vec2 posMeters = body->body->GetPosition();
-
-        // Get game module to check gasoline
-        ModuleGame* game = (ModuleGame*)listener;
-        float dt = GetFrameTime();
-
-        // ---- REGENERATE IF INSIDE BROWN RECTANGLE (world coords) ----
-        if (!isAI)
-        {
-            int car_px, car_py;
-            body->GetPhysicPosition(car_px, car_py);
-
-            const int brown1_x = 13360;
-            const int brown1_y = 5100;
-            const int brown2_x = 5800;
-            const int brown2_y = 4230;
-            const int brown_w = 300;
-            const int brown_h = 150;
-
-            bool insideBrown = false;
-            if (car_px >= brown1_x && car_px <= brown1_x + brown_w && car_py >= brown1_y && car_py <= brown1_y + brown_h)
-                insideBrown = true;
-            else if (car_px >= brown2_x && car_px <= brown2_x + brown_w && car_py >= brown2_y && car_py <= brown2_y + brown_h)
-                insideBrown = true;
-
-            const float stop_threshold = 0.05f;
-            if (insideBrown && fabsf(speedCar) < stop_threshold && forwardInput == 0.0f)
-            {
-                game->gasoline += 20.0f * dt;
-                if (game->gasoline > (float)game->max_gasoline) game->gasoline = (float)game->max_gasoline;
-
-                // Play refueling FX once when starting to refuel
-                if (!game->refueling)
-                {
-                    game->refueling = true;
-                    if (game->App && game->App->audio && game->gasoline_fx != 0)
-                    {
-                        game->App->audio->PlayFx(game->gasoline_fx);
-                    }
-                }
-            }
-            else
-            {
-                // if we leave the brown area or start moving, reset refueling flag
-                if (game->refueling)
-                    game->refueling = false;
-            }
-        }
-        // ---- ACELERAR / FRENAR ----
-        bool canAccelerate = true;
-        if (!isAI) canAccelerate = (game->gasoline > 0.0f);
-
-        bool inputMoving = (forwardInput > 0.0f || forwardInput < 0.0f);
-
-        if (isAI)
-        {
-            if (forwardInput > 0.0f)
-            {
-                speedCar += acceleration;
-                if (speedCar > maxSpeed) speedCar = maxSpeed;
-            }
-            else if (forwardInput < 0.0f)
-            {
-                speedCar -= acceleration;
-                if (speedCar < -maxSpeed) speedCar = -maxSpeed;
-            }
-        }
-        else
-        {
-            // Hard brake when player presses SPACE
-            const float hardBrakePower = 0.6f; // strong deceleration per frame
-            if (hardBrake)
-            {
-                if (speedCar > 0.0f)
-                {
-                    speedCar -= hardBrakePower;
-                    if (speedCar < 0.0f) speedCar = 0.0f;
-                }
-                else if (speedCar < 0.0f)
-                {
-                    speedCar += hardBrakePower;
-                    if (speedCar > 0.0f) speedCar = 0.0f;
-                }
-            }
-            else if (inputMoving && canAccelerate)
-            {
-                if (forwardInput > 0.0f)
-                {
-                    speedCar += acceleration;
-                    if (speedCar > maxSpeed) speedCar = maxSpeed;
-                }
-                else if (forwardInput < 0.0f)
-                {
-                    speedCar -= acceleration;
-                    if (speedCar < -maxSpeed) speedCar = -maxSpeed;
-                }
-
-                // Drain gasoline while player is pressing throttle
-                game->gasoline -= game->gasoline_drain_rate * dt;
-                if (game->gasoline < 0.0f) game->gasoline = 0.0f;
-            }
-            else
-            {
-                if (speedCar > 0.0f)
-                {
-                    speedCar -= braking;
-                    if (speedCar < 0.0f) speedCar = 0.0f;
-                }
-                else if (speedCar < 0.0f)
-                {
-                    speedCar += braking;
-                    if (speedCar > 0.0f) speedCar = 0.0f;
-                }
-            }
-        }
-
-        // ---- GIRO DEL COCHE ----
-        float speedFactor = fabsf(speedCar);
-        float baseTurnSpeedRad = baseTurnSpeedDeg * DEGTORAD;
-
-        angle += steeringInput * baseTurnSpeedRad * speedFactor;
-
-        if (steeringInput != 0.0f)
-        {
-            steeringVisual += steeringInput * steerVisualSpeed;
-            if (steeringVisual > maxSteerVisualDeg) steeringVisual = maxSteerVisualDeg;
-            if (steeringVisual < -maxSteerVisualDeg) steeringVisual = -maxSteerVisualDeg;
-        }
-        else
-        {
-            steeringVisual *= 0.85f;
-        }
-
-        // ---- APLICAR A BOX2D ----
-        body->body->SetTransform(posMeters, angle);
-
-        b2Vec2 vel;
-        vel.x = cosf(angle) * speedCar * moveFactor;
-        vel.y = sinf(angle) * speedCar * moveFactor;
-        body->body->SetLinearVelocity(vel);
-    }
-
-    // ---------------------- DIBUJAR COCHE ----------------------
-    void DrawCar()
-    {
-        int x, y;
-        body->GetPhysicPosition(x, y);
-        float angle = body->GetRotation();
-        float angleDeg = angle * RAD2DEG;
-
-        // --- CMARA (offset pantalla) ---
-        ModuleGame* game = (ModuleGame*)listener;
-        float camX = game->App->renderer->camera.x;
-        float camY = game->App->renderer->camera.y;
-
-        float scale = 0.05f;
-
-        // ===== CARROCERA =====
-        Rectangle srcBody = { 0, 0, (float)bodyTexture.width, (float)bodyTexture.height };
-        Rectangle dstBody = {
-            (float)x + camX, (float)y + camY,
-            bodyTexture.width * scale,
-            bodyTexture.height * scale
-        };
-        Vector2 originBody = { dstBody.width / 2.0f, dstBody.height / 2.0f };
-
-        DrawTexturePro(bodyTexture, srcBody, dstBody, originBody, angleDeg, WHITE);
-
-        // ===== MORRO =====
-        Texture2D* frontTex = &gFrontCarTexture;
-        if (steeringInput < -0.1f) frontTex = &gFrontCarTextureLeft;
-        else if (steeringInput > 0.1f) frontTex = &gFrontCarTextureRight;
-
-        float bodyW = dstBody.width;
-        float forwardOffset = bodyW * 0.00f;
-
-        float cosA = cosf(angle);
-        float sinA = sinf(angle);
-
-        Vector2 frontPos;
-        frontPos.x = (float)x + camX + cosA * forwardOffset;
-        frontPos.y = (float)y + camY + sinA * forwardOffset;
-
-        Rectangle srcFront = { 0, 0, (float)frontTex->width, (float)frontTex->height };
-        Rectangle dstFront = {
-            frontPos.x, frontPos.y,
-            frontTex->width * scale,
-            frontTex->height * scale
-        };
-        Vector2 originFront = { dstFront.width / 2.0f, dstFront.height / 2.0f };
-
-        DrawTexturePro(*frontTex, srcFront, dstFront, originFront, angleDeg, WHITE);
-    }
-
-private:
-    Texture2D bodyTexture;
-    Texture2D frontTexture;
-
-    bool isAI = false;
-
-    float forwardInput = 0.0f;
-    float steeringInput = 0.0f;
-
-    float speedCar = 0.0f;
-    float steeringVisual = 0.0f;
-
-    const float acceleration = 0.115f;
-    const float braking = 0.020f;
-    const float maxSpeed = 12.0f;
-
-    const float moveFactor = 2.0f;
-    const float baseTurnSpeedDeg = 0.35f;
-
-    const float maxSteerVisualDeg = 12.0f;
-    const float steerVisualSpeed = 1.5f;
-    bool hardBrake = false;
-
-};
+// Rates per second of simulation, tuned to the old per-frame values at 30 FPS
+// (the world used to advance 1/60 s per frame, hence moveFactor halved)
+static const float kAcceleration = 3.45f;
+static const float kBraking = 0.6f;
+static const float kMaxSpeed = 12.0f;
+static const float kHardBrakePower = 18.0f; // strong deceleration per second
+
+static const float kMoveFactor = 1.0f;
+static const float kBaseTurnSpeedDeg = 10.5f;
+
+static const float kMaxSteerVisualDeg = 12.0f;
+static const float kSteerVisualSpeed = 45.0f;
+
+// Minimum AI cars per job. Steering costs ~70 ns per car (RaceBench), so 256 cars
+// are ~18 us of work against ~1-2 us to queue a job and wake a worker. The 11 cars
+// of a normal race stay inline, big fields split in up to 4 pieces per thread
+static const int kAIJobGrain = 256;
+
+// Racing line driving: look-ahead point the AI steers to and how it follows the speed profile
+static const float kLookAhead = 64.0f;          // px
+static const float kLookAheadTime = 0.15f;      // s of travel added to the look-ahead
+static const float kBrakeLead = 32.0f;          // px, speed target read this far ahead
+static const float kSpeedMargin = 0.5f;         // over target by more than this: brake
+static const float kLineSteer = 1.0f;
+static const float kMissedCheckpoint = 150.0f;  // px past its next checkpoint: go back for it
+static const float kRecoverSpeed = 4.0f;
+
+// --cars: field spread around the lap
+static const int kFieldAbreast = 3;
+static const float kFieldLaneWidth = 45.0f;     // px between cars of a row
+static const float kFieldMinSpacing = 100.0f;   // px between rows, below it the cars overlap
+
+// Pantalla de carga: ms per frame spent finishing assets on the main thread
+static const float kLoadBudgetMs = 8.0f;
+
+// Mapa dibujado a escala 1: pixeles del mapa = pixeles de pantalla
+constexpr float MAP_SCALE = 1.0f;
+
+// Sonido de motor: rpm por marcha, las IA mas bajas que el player
+static const int kEngineGears = 6;
+static const float kEngineAIVolume = 0.6f;
 
 // =====================================================================
 // MODULE GAME
@@ -439,8 +107,6 @@ ModuleGame::ModuleGame(Application* app, bool start_enabled) : Module(app, start
 {
     ray_on = false;
     sensed = false;
-    lapCount = 0;
-    nextCheckpoint = 1;
 }
 
 ModuleGame::~ModuleGame()
@@ -452,31 +118,51 @@ bool ModuleGame::Start()
     LOG("Loading Game assets");
     bool ret = true;
 
-    App->renderer->camera.x = App->renderer->camera.y = 0;
-
-    // mapa
-    mapaMontmelo = LoadTexture("Assets/mapa_montmelo.png");
-
-    // Texturas del coche
-    carTexture = LoadTexture("Assets/f1_body_car.png");
-    gFrontCarTexture = LoadTexture("Assets/f1_front_car.png");
-    gFrontCarTextureLeft = LoadTexture("Assets/f1_front_car_Left.png");
-    gFrontCarTextureRight = LoadTexture("Assets/f1_front_car_Right.png");
-
-    bonus_fx = App->audio->LoadFx("Assets/bonus.wav");
-    gasoline_fx = App->audio->LoadFx("Assets/f1-radio-box-box.mp3");
-    motor_down_fx = App->audio->LoadFx("Assets/motor_down.mp3");
-    countdown_beep_fx = App->audio->LoadFx("Assets/countdown_beep.mp3");
-    countdown_end_beep_fx = App->audio->LoadFx("Assets/countdown_end_beep.mp3");
+    // Headless: no GPU, nothing is drawn so nothing to load
+    if (!App->IsHeadless())
+    {
+        App->renderer->camera.x = App->renderer->camera.y = 0;
+
+        // Assets: decoded in parallel on the job workers, uploaded a few per frame by
+        // Update() while the loading screen is up. Sounds first, in the same order as
+        // always (their ids)
+        loader.AddSound("Assets/bonus.wav", App->audio, &bonus_fx);
+        loader.AddSound("Assets/f1-radio-box-box.mp3", App->audio, &gasoline_fx);
+        loader.AddSound("Assets/motor_down.mp3", App->audio, &motor_down_fx);
+        loader.AddSound("Assets/countdown_beep.mp3", App->audio, &countdown_beep_fx);
+        loader.AddSound("Assets/countdown_end_beep.mp3", App->audio, &countdown_end_beep_fx);
+
+        // Texturas del coche
+        loader.AddTexture("Assets/f1_body_car.png", &carTexture);
+        loader.AddTexture("Assets/f1_front_car.png", &gFrontCarTexture);
+        loader.AddTexture("Assets/f1_front_car_Left.png", &gFrontCarTextureLeft);
+        loader.AddTexture("Assets/f1_front_car_Right.png", &gFrontCarTextureRight);
+
+        // mapa (streamed in tiles, only the ones around the camera live on the GPU)
+        // The baked pack is mapped with no decode work, the PNG is only a fallback.
+        // Loading it is all CPU work, the tiles are uploaded when first drawn
+        loader.AddTask("mapa_montmelo", [this]()
+        {
+            return mapaMontmelo.LoadPack("Assets/mapa_montmelo.tilepack") || mapaMontmelo.Load("Assets/mapa_montmelo.png");
+        });
 
-    entities.clear();
+        loader.Start(App->jobs);
+    }
 
-    // seed randomness for AI behavior
-    std::srand((unsigned)std::time(nullptr));
+    // Repeticion: the recording brings its own seed and drives the player
+    replay.Clear();
+    replaySynced = false;
+    if (App->GetReplayPath() != nullptr && !replay.Load(App->GetReplayPath()))
+    {
+        LOG("Cannot load replay: %s", App->GetReplayPath());
+        return false;
+    }
 
     // Initialize pre-start screen and countdown (countdown starts after ENTER)
-    sPreStartScreen = true;
-    sStartCountdownFrames = 0;
+    // (headless and replays start racing right away, there is nobody to press ENTER)
+    sPreStartScreen = !App->IsHeadless() && !replay.IsPlaying();
+    sStartCountdown = 0.0f;
+    sSimTime = 0.0f;
 
     // Play pre-start music (looping handled by ModuleAudio update)
     if (App->audio)
@@ -485,59 +171,35 @@ bool ModuleGame::Start()
         if (!ok) LOG("Warning: pre-start music failed to play");
     }
 
-    // Coche jugador
-    car = new Box(App->physics,
-        10779,
-        5460,
-        this,
-        carTexture,
-        gFrontCarTexture,
-        false);
-
-    entities.emplace_back(car);
-
-    b2Vec2 pos = car->body->body->GetPosition();
-    car->body->body->SetTransform(pos, PI);
-
-    car->body->body->SetFixedRotation(true);
+    // Coches: fila 0 el jugador (headless with no replay: driven by the AI), 1..N las IA
+    const int NUM_AI = 10;
+    int aiCount = App->GetCarCount() > 0 ? App->GetCarCount() : NUM_AI;
 
-    // --- limpiar IA ---
-    aiCars.clear();
-    aiNextCP.clear();
-    aiLaps.clear();
+    cars.Clear();
+    cars.Reserve(1 + aiCount);
 
-    const int NUM_AI = 10;
+    int player = cars.Add(App->physics->CreateRectangle(10779, 5460, kCarWidth, kCarHeight), App->IsHeadless() && !replay.IsPlaying());
+    b2Body* playerBody = cars.body[player]->body;
+    playerBody->SetTransform(playerBody->GetPosition(), PI);
+    playerBody->SetFixedRotation(true);
 
-    for (int i = 0; i < NUM_AI; ++i)
+    for (int i = 0; i < aiCount; ++i)
     {
         int spawnX = 10779 + (i + 1) * 80;
-        int spawnY = 5460 + (i % 2) * 60;
-
-        Box* ai = new Box(App->physics,
-            spawnX, spawnY,
-            this,
-            carTexture,
-            gFrontCarTexture,
-            true,
-            i
-        );
-
-        entities.emplace_back(ai);
-        aiCars.push_back(ai);
+        // Staggered rows, the player counts as the first car: 80 px apart on the same
+        // row the 90 px bodies would overlap and shove each other before the start
+        int spawnY = 5460 + ((i + 1) % 2) * 60;
 
-        aiNextCP.push_back(0);
-        aiLaps.push_back(0);
+        int ai = cars.Add(App->physics->CreateRectangle(spawnX, spawnY, kCarWidth, kCarHeight), true);
 
-        b2Vec2 posAI = ai->body->body->GetPosition();
-        ai->body->body->SetTransform(posAI, PI);
+        b2Body* aiBody = cars.body[ai]->body;
+        aiBody->SetTransform(aiBody->GetPosition(), PI);
 
-        ai->body->body->SetFixedRotation(true);
-        ai->body->body->SetLinearDamping(3.0f);
-        ai->body->body->SetAngularDamping(5.0f);
+        aiBody->SetFixedRotation(true);
+        aiBody->SetLinearDamping(3.0f);
+        aiBody->SetAngularDamping(5.0f);
     }
 
-    car->body->body->SetFixedRotation(true);
-
     // ================= CHECKPOINTS =================
     struct CheckpointData { int x, y, w, h; };
 
@@ -700,34 +362,64 @@ bool ModuleGame::Start()
         {12205, 5379, 300, 120}, // 154
     };
 
-    checkpoints.clear();
+    // Plain rectangles in order, no sensor bodies in the broadphase
+    track.Clear();
     for (const auto& cp : cpData)
+        track.AddCheckpoint(cp.x, cp.y, cp.w, cp.h);
+
+    // Baked from the same checkpoints by Tools/RacingLineBaker
+    checkpointLine.clear();
+    if (racingLine.Load("Assets/mapa_montmelo.racingline"))
+    {
+        // Where every checkpoint falls along the line, each search starting from the previous one
+        float hint = 0.0f;
+        for (int i = 0; i < track.GetCheckpointCount(); ++i)
+        {
+            const TrackCheckpoint& cp = track.GetCheckpoint(i);
+            hint = racingLine.Track(hint, cp.x, cp.y);
+            checkpointLine.push_back(hint);
+        }
+    }
+    else
     {
-        PhysBody* sensor = App->physics->CreateRectangleSensor(cp.x, cp.y, cp.w, cp.h);
-        sensor->listener = this;
-        checkpoints.push_back(sensor);
+        LOG("Racing line not found, AI drives checkpoint to checkpoint");
     }
 
+    // --cars: a field that big does not fit on the grid, it goes around the lap behind the player
+    if (App->GetCarCount() > 0)
+    {
+        if (racingLine.IsLoaded()) SpreadField();
+        else LOG("Racing line not found, the %d cars stay on the grid", aiCount);
+    }
+
+    // Un generador por coche a partir de la semilla de la carrera (replay, --seed, si no el reloj)
+    if (replay.IsPlaying()) raceSeed = replay.GetSeed();
+    else raceSeed = App->GetSeed() != 0 ? App->GetSeed() : (uint64)std::time(nullptr);
+    cars.SeedRandom(raceSeed);
+
+    if (App->GetRecordPath() != nullptr && !replay.IsPlaying())
+        replay.BeginRecording(raceSeed);
+
+    // The ghost keeps the best lap across restarts, only the lap being recorded starts over
+    ghost.BeginLap();
+
+    // Same fuel on every start, a replay has to begin from the recorded state
+    gasoline = (float)max_gasoline;
+
+    // Snapshot de dibujado, mismo orden que el leaderboard (0 player, 1..N IA)
+    carRender.assign(cars.Size(), CarRenderState());
+
     // Reset contadores
-    lapCount = 0;
-    nextCheckpoint = 0;
+    leaderboard.Reset(cars.Size());
 
-    // ===== RESET TIMERS (STATIC) =====
+    // ===== RESET TIMERS =====
     sRaceFinished = false;
     sAiWon = false;
     sEndTime = 0.0f;
     sPlayerWon = false;
 
     // DO NOT start lap timers yet; they'll be set when countdown finishes
-    sPlayerLapStart = 0.0f;
-    sPlayerLapCurrent = 0.0f;
-    sPlayerLapLast = 0.0f;
-    sPlayerLapBest = 999999.0f;
-
-    sAiLapStart.assign(aiCars.size(), 0.0f);
-    sAiLapCurrent.assign(aiCars.size(), 0.0f);
-    sAiLapLast.assign(aiCars.size(), 0.0f);
-    sAiLapBest.assign(aiCars.size(), 999999.0f);
+    cars.ResetRace(0.0f);
 
     return ret;
 }
@@ -736,31 +428,328 @@ bool ModuleGame::CleanUp()
 {
     LOG("Unloading Game scene");
 
-    for (PhysicEntity* e : entities)
-        delete e;
-    entities.clear();
+    if (App->IsHeadless())
+        PrintRaceResults();
+
+    // Los coches desaparecen: sus motores sueltan las voces (R reinicia con la pantalla
+    // de carga, que tampoco llama a UpdateEngineSound)
+    if (App->audio)
+    {
+        App->audio->SilenceEngines();
+    }
+
+    // The file keeps the last race recorded (R restarts record a new one)
+    if (replay.IsRecording() && replay.GetTickCount() > 0)
+    {
+        if (!replay.Save(App->GetRecordPath(), RaceChecksum()))
+            LOG("Cannot save replay: %s", App->GetRecordPath());
+    }
+    replay.Clear();
+
+    for (PhysBody* body : cars.body)
+    {
+        App->physics->DeleteBody(body);
+        delete body;
+    }
+    cars.Clear();
+
+    // Decodes still running write into the textures and the map
+    loader.Clear();
 
-    UnloadTexture(carTexture);
-    UnloadTexture(gFrontCarTexture);
-    UnloadTexture(gFrontCarTextureLeft);
-    UnloadTexture(gFrontCarTextureRight);
-    UnloadTexture(mapaMontmelo);
+    if (!App->IsHeadless())
+    {
+        UnloadTexture(carTexture);
+        UnloadTexture(gFrontCarTexture);
+        UnloadTexture(gFrontCarTextureLeft);
+        UnloadTexture(gFrontCarTextureRight);
+        mapaMontmelo.Unload();
+    }
 
     return true;
 }
 
+uint32 ModuleGame::RaceChecksum() const
+{
+    // FNV-1a over the raw bits: a single float ulp apart is a different race
+    uint32 hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t size)
+    {
+        const uchar* bytes = (const uchar*)data;
+        for (size_t b = 0; b < size; ++b)
+        {
+            hash ^= bytes[b];
+            hash *= 16777619u;
+        }
+    };
+
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        mix(&cars.x[i], sizeof(float));
+        mix(&cars.y[i], sizeof(float));
+        mix(&cars.angle[i], sizeof(float));
+        mix(&cars.speed[i], sizeof(float));
+        mix(&cars.track[i].lap, sizeof(int));
+        mix(&cars.track[i].next_checkpoint, sizeof(int));
+    }
+    mix(&gasoline, sizeof(float));
+
+    return hash;
+}
+
+void ModuleGame::PrintRaceResults() const
+{
+    printf("Race %s after %.1f s of simulation (seed %llu)\n", sRaceFinished ? "finished" : "stopped", sSimTime, (unsigned long long)raceSeed);
+
+    for (int r = 0; r < leaderboard.GetCarCount(); ++r)
+    {
+        int c = leaderboard.GetCar(r);
+        const TrackPosition& pos = cars.track[c];
+        float best = cars.lap_best[c];
+
+        char bestStr[32];
+        FormatTime((best >= 999998.0f) ? 0.0f : best, bestStr, 32);
+
+        if (c == 0) printf("P%-3d PLAYER  laps %d  best %s\n", r + 1, pos.lap, bestStr);
+        else printf("P%-3d AI%02d    laps %d  best %s\n", r + 1, c, pos.lap, bestStr);
+    }
+
+    if (ghost.HasBest())
+    {
+        char ghostStr[32];
+        FormatTime(ghost.GetBestTime(), ghostStr, 32);
+        printf("Ghost lap %s: %d ticks in %d bytes\n", ghostStr, ghost.GetBestTicks(), ghost.GetBestBytes());
+    }
+
+    if (replay.IsPlaying())
+    {
+        if (!replay.IsFinished()) printf("Replay stopped at tick %u of %u\n", replay.GetTick(), replay.GetTickCount());
+        else printf("Replay of %u ticks %s\n", replay.GetTickCount(), replaySynced ? "in sync" : "OUT OF SYNC");
+    }
+}
+
+void ModuleGame::UpdateEngineSound()
+{
+    if (App->audio == nullptr || !App->audio->IsEnabled()) return;
+
+    // Oyente en el centro de la pantalla, en pixeles del mapa
+    float listenerX = ((float)SCREEN_WIDTH * 0.5f - App->renderer->camera.x) / MAP_SCALE;
+    float listenerY = ((float)SCREEN_HEIGHT * 0.5f - App->renderer->camera.y) / MAP_SCALE;
+    App->audio->SetListener(listenerX, listenerY);
+
+    // Un motor por coche, el audio decide cuales se mezclan
+    App->audio->SetEngineCount(cars.Size());
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        // rpm: sube en cada marcha y cae al cambiar a la siguiente
+        float s = MIN(fabsf(cars.speed[i]) / kMaxSpeed, 1.0f);
+        int gear = MIN((int)(s * kEngineGears), kEngineGears - 1);
+        float inGear = s * kEngineGears - gear;
+        float rpm = gear == 0 ? 0.1f + 0.9f * inGear : 0.45f + 0.55f * inGear;
+
+        bool player = (i == CAR_PLAYER);
+        App->audio->SetEngine(i, cars.x[i], cars.y[i], rpm, fabsf(cars.forward_input[i]),
+            player ? 1.0f : kEngineAIVolume, player ? AUDIO_PRIORITY_HIGH : AUDIO_PRIORITY_NORMAL);
+    }
+}
+
+void ModuleGame::DrawLoadingScreen() const
+{
+    DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, BLACK);
+
+    const char* title = "LOADING";
+    int titleSize = 60;
+    DrawText(title, (SCREEN_WIDTH - MeasureText(title, titleSize)) / 2, SCREEN_HEIGHT / 2 - 100, titleSize, WHITE);
+
+    // Barra de progreso y el asset que falta
+    int barW = 600;
+    int barH = 24;
+    int barX = (SCREEN_WIDTH - barW) / 2;
+    int barY = SCREEN_HEIGHT / 2;
+    DrawRectangleLines(barX, barY, barW, barH, WHITE);
+    DrawRectangle(barX + 2, barY + 2, (int)((barW - 4) * loader.GetProgress()), barH - 4, RED);
+    DrawText(loader.GetCurrentName(), barX, barY + barH + 12, 20, GRAY);
+}
+
+void ModuleGame::DrawTrackMap(Rectangle area)
+{
+    if (!mapaMontmelo.IsLoaded()) return;
+
+    // Mapa entero dentro de area, manteniendo la proporcin
+    float mapW = (float)mapaMontmelo.GetWidth();
+    float mapH = (float)mapaMontmelo.GetHeight();
+    float scale = MIN(area.width / mapW, area.height / mapH);
+    float mapX = area.x + (area.width - mapW * scale) * 0.5f;
+    float mapY = area.y + (area.height - mapH * scale) * 0.5f;
+
+    // The tile map picks the reduced level matching this scale
+    mapaMontmelo.Draw(area, mapX, mapY, scale);
+
+    for (int i = (int)carRender.size() - 1; i >= 0; --i)
+    {
+        const CarRenderState& rs = carRender[i];
+        if (i == 0) DrawCircle((int)(mapX + rs.x * scale), (int)(mapY + rs.y * scale), 4.0f, YELLOW);
+        else DrawCircle((int)(mapX + rs.x * scale), (int)(mapY + rs.y * scale), 3.0f, RED);
+    }
+}
+
+void ModuleGame::CollectRenderState(float alpha)
+{
+    // Interpolated between the last two ticks
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        CarRenderState& rs = carRender[i];
+        const PhysBody* body = cars.body[i];
+
+        body->GetInterpolatedPosition(alpha, rs.x, rs.y);
+        rs.angle = body->GetInterpolatedRotation(alpha);
+
+        float steering = cars.steering_input[i];
+        rs.sprite = CAR_SPRITE_STRAIGHT;
+        if (steering < -0.1f) rs.sprite = CAR_SPRITE_LEFT;
+        else if (steering > 0.1f) rs.sprite = CAR_SPRITE_RIGHT;
+    }
+
+    // The last recorded ghost tick is the player's pose after the last step, the player
+    // is drawn between the two last steps: the ghost goes the same fraction of its lap
+    ghostVisible = ghost.Sample(ghost.GetRecordedTicks() - 2 + alpha, ghostRender.x, ghostRender.y, ghostRender.angle);
+}
+
+void ModuleGame::DrawCars() const
+{
+    // El fantasma debajo de los coches
+    if (ghostVisible) DrawCar(ghostRender, Fade(WHITE, 0.35f));
+
+    for (const CarRenderState& rs : carRender)
+        DrawCar(rs, WHITE);
+}
+
+void ModuleGame::DrawCar(const CarRenderState& rs, Color tint) const
+{
+    float camX = App->renderer->camera.x;
+    float camY = App->renderer->camera.y;
+
+    const float scale = 0.05f;
+
+    // Cars whose sprite cannot reach the screen are not drawn at all
+    float spriteW = MAX(carTexture.width, gFrontCarTexture.width) * scale;
+    float spriteH = MAX(carTexture.height, gFrontCarTexture.height) * scale;
+    float cullRadius = 0.5f * sqrtf(spriteW * spriteW + spriteH * spriteH);
+
+    float sx = rs.x + camX;
+    float sy = rs.y + camY;
+    if (sx < -cullRadius || sy < -cullRadius || sx > SCREEN_WIDTH + cullRadius || sy > SCREEN_HEIGHT + cullRadius)
+        return;
+
+    float angleDeg = rs.angle * RAD2DEG;
+
+    // ===== CARROCERA =====
+    Rectangle srcBody = { 0, 0, (float)carTexture.width, (float)carTexture.height };
+    Rectangle dstBody = { sx, sy, carTexture.width * scale, carTexture.height * scale };
+    Vector2 originBody = { dstBody.width / 2.0f, dstBody.height / 2.0f };
+
+    DrawTexturePro(carTexture, srcBody, dstBody, originBody, angleDeg, tint);
+
+    // ===== MORRO =====
+    const Texture2D* frontTex = &gFrontCarTexture;
+    if (rs.sprite == CAR_SPRITE_LEFT) frontTex = &gFrontCarTextureLeft;
+    else if (rs.sprite == CAR_SPRITE_RIGHT) frontTex = &gFrontCarTextureRight;
+
+    Rectangle srcFront = { 0, 0, (float)frontTex->width, (float)frontTex->height };
+    Rectangle dstFront = { sx, sy, frontTex->width * scale, frontTex->height * scale };
+    Vector2 originFront = { dstFront.width / 2.0f, dstFront.height / 2.0f };
+
+    DrawTexturePro(*frontTex, srcFront, dstFront, originFront, angleDeg, tint);
+}
+
+update_status ModuleGame::FixedUpdate(float dt)
+{
+    if (cars.Size() == 0 || sPreStartScreen || sRaceFinished || !loader.IsDone()) return UPDATE_CONTINUE;
+
+    // Cuenta atras: when it finishes this tick, lap timers start now
+    if (sStartCountdown > 0.0f)
+    {
+        sStartCountdown -= dt;
+        if (sStartCountdown <= 0.0f)
+        {
+            sStartCountdown = 0.0f;
+            cars.ResetRace(sSimTime);
+            // Play end beep
+            if (countdown_end_beep_fx != 0)
+                App->audio->PlayFx(countdown_end_beep_fx);
+        }
+        return UPDATE_CONTINUE;
+    }
+
+    sSimTime += dt;
+
+    // Una pasada por etapa sobre la tabla de coches:
+    // estado de los bodies -> controles -> movimiento -> progreso en carrera
+    GatherCarState();
+    ghost.Record(cars.x[CAR_PLAYER], cars.y[CAR_PLAYER], cars.angle[CAR_PLAYER]);
+    if (replay.IsPlaying())
+    {
+        // Once the recording is over the player just lets go of the keys
+        uchar input = 0;
+        replay.Next(input);
+        ApplyPlayerInput(input);
+    }
+    else if (!cars.is_ai[CAR_PLAYER])
+    {
+        ReadPlayerInput();
+    }
+
+    App->profiler->BeginScope("AI");
+    UpdateAISteering();
+    App->profiler->EndScope();
+
+    App->profiler->BeginScope("Movement");
+    UpdateRefuel(dt);
+    UpdateCarMovement(dt);
+    App->profiler->EndScope();
+
+    App->profiler->BeginScope("Checkpoints");
+    UpdateRaceProgress();
+    App->profiler->EndScope();
+
+    // ===== CRONOS ACTUALES =====
+    for (int i = 0; i < cars.Size(); ++i)
+        cars.lap_current[i] = sSimTime - cars.lap_start[i];
+
+    // Last recorded tick: the race has to be exactly where it was when recorded
+    if (replay.IsPlaying() && replay.GetTick() == replay.GetTickCount())
+    {
+        replaySynced = RaceChecksum() == replay.GetChecksum();
+        if (!replaySynced) LOG("Replay out of sync after %u ticks", replay.GetTickCount());
+    }
+
+    return UPDATE_CONTINUE;
+}
+
 update_status ModuleGame::Update()
 {
-    constexpr float MAP_SCALE = 1.0f;
+    // Headless: the race is all simulation, stop as soon as someone wins
+    if (App->IsHeadless())
+        return (sRaceFinished || replay.IsFinished()) ? UPDATE_STOP : UPDATE_CONTINUE;
+
+    // Loading: the assets finish a few per frame, the rest of the game waits
+    if (!loader.IsDone())
+    {
+        loader.Update(kLoadBudgetMs);
+        DrawLoadingScreen();
+        return UPDATE_CONTINUE;
+    }
 
     // Posicin del coche
-    int carPx = 0, carPy = 0;
-    float carAngle = 0.0f;
+    float carPx = 0.0f, carPy = 0.0f;
 
-    if (car != nullptr)
+    if (cars.Size() > 0)
     {
-        car->body->GetPhysicPosition(carPx, carPy);
-        carAngle = car->body->GetRotation() * RAD2DEG;
+        // Pipeline: input -> simulate (FixedUpdate) -> render state -> draw.
+        // From here on drawing only reads the snapshot, never the bodies
+        CollectRenderState(App->GetFixedAlpha());
+
+        carPx = carRender[0].x;
+        carPy = carRender[0].y;
 
     }
     else
@@ -794,7 +783,7 @@ update_status ModuleGame::Update()
         {
             // Start countdown
             sPreStartScreen = false;
-            sStartCountdownFrames =90; //3 seconds @30fps
+            sStartCountdown = kCountdownTime;
 
             // Stop pre-start music
             if (App->audio)
@@ -809,23 +798,23 @@ update_status ModuleGame::Update()
             }
         }
 
-        // Ensure motor sound is stopped while on pre-start screen
-        if (App->audio && motorPlaying)
+        // Engines silent while on pre-start screen
+        if (App->audio)
         {
-            App->audio->StopMotor();
-            motorPlaying = false;
+            App->audio->SilenceEngines();
         }
+        motorPlaying = false;
 
         return UPDATE_CONTINUE;
     }
 
     // If start countdown still running, draw countdown and skip the rest
-    if (sStartCountdownFrames > 0)
+    if (sStartCountdown > 0.0f)
     {
         // Draw a simple full-screen countdown
         DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Color{ 0, 0, 0, 255 });
 
-        int number = (sStartCountdownFrames + 29) / 30; // 90->3, 60->2, 30->1
+        int number = (int)ceilf(sStartCountdown); // 3, 2, 1
         char buf[8];
         std::snprintf(buf, sizeof(buf), "%d", number);
 
@@ -844,30 +833,9 @@ update_status ModuleGame::Update()
         int textW = MeasureText(buf, fontSize);
         DrawText(buf, (SCREEN_WIDTH - textW) / 2, (SCREEN_HEIGHT - fontSize) / 2, fontSize, WHITE);
 
-        sStartCountdownFrames--;
-
-        // When countdown finishes this frame, initialize lap timers to now
-        if (sStartCountdownFrames == 0)
-        {
-            float now = (float)GetTime();
-            sPlayerLapStart = now;
-            sAiLapStart.assign(aiCars.size(), now);
-            // Play end beep
-            if (countdown_end_beep_fx != 0)
-                App->audio->PlayFx(countdown_end_beep_fx);
-        }
-
         return UPDATE_CONTINUE;
     }
 
-    // ===== CRONOS ACTUALES =====
-    sPlayerLapCurrent = (float)GetTime() - sPlayerLapStart;
-    for (int i = 0; i < (int)aiCars.size(); ++i)
-    {
-        if (i < (int)sAiLapStart.size())
-            sAiLapCurrent[i] = (float)GetTime() - sAiLapStart[i];
-    }
-
     // ===== GUARDAR COORDENADAS CON TECLA =====
     //if (IsKeyPressed(KEY_P))
     //{
@@ -922,8 +890,10 @@ update_status ModuleGame::Update()
     float cam_y = App->renderer->camera.y;
 
     // Dibuja el MAPA como mundo
-    Vector2 mapPos = { cam_x, cam_y };
-    DrawTextureEx(mapaMontmelo, mapPos, 0.0f, MAP_SCALE, WHITE);
+    App->profiler->BeginScope("Map");
+    mapaMontmelo.BeginFrame();
+    mapaMontmelo.Draw(cam_x, cam_y, MAP_SCALE);
+    App->profiler->EndScope();
 
     // brown rectangles
     DrawRectangle((int)(13360 + cam_x), (int)(5100 + cam_y), 300, 150, BROWN);
@@ -966,27 +936,9 @@ update_status ModuleGame::Update()
         // Reset con R
         if (IsKeyPressed(KEY_R))
         {
-            // Reinicia contadores
-            lapCount =0;
-            nextCheckpoint =0;
-
-            // Reinicia IAs
-            for (int i =0; i < (int)aiLaps.size(); ++i)
-            {
-                aiLaps[i] =0;
-                aiNextCP[i] =0;
-            }
-
-            // Reinicia timers
-            sPlayerLapStart = (float)GetTime();
-            sPlayerLapCurrent =0.0f;
-            sPlayerLapLast =0.0f;
-            sPlayerLapBest =999999.0f;
-
-            sAiLapStart.assign(aiCars.size(), (float)GetTime());
-            sAiLapCurrent.assign(aiCars.size(),0.0f);
-            sAiLapLast.assign(aiCars.size(),0.0f);
-            sAiLapBest.assign(aiCars.size(),999999.0f);
+            // Reinicia contadores y timers (jugador + IAs)
+            cars.ResetRace(sSimTime);
+            leaderboard.Reset(cars.Size());
 
             // Reinicia estado end
             sRaceFinished = false;
@@ -1004,16 +956,7 @@ update_status ModuleGame::Update()
                 if (!ok) LOG("Warning: pre-start music failed to play on restart");
             }
 
-            // Recolocar coches (mismo spawn que Start)
-            if (car && car->body && car->body->body)
-            {
-                b2Vec2 p = car->body->body->GetPosition();
-                // SetTransform recibe metros, pero t ests spawneando por CreateRectangle(x,y) en pxeles.
-                // Si tu CreateRectangle ya convierte internamente, puedes volver a crear o usar el mismo patrn de Start:
-                // Aqu lo ms seguro: volver a Start() si tu profe lo permite.
-            }
-
-            // MUY SENCILLO Y SEGURO: reinicia escena completa
+            // Recolocar coches: CleanUp destruye los bodies y Start los vuelve a crear en el spawn
             CleanUp();
             Start();
         }
@@ -1021,38 +964,51 @@ update_status ModuleGame::Update()
         return UPDATE_CONTINUE;
     }
 
-    // Actualizar entidades
-    for (PhysicEntity* entity : entities)
-        entity->Update();
+    // Dibujar coches (la simulacion va en FixedUpdate)
+    App->profiler->BeginScope("Cars");
+    DrawCars();
+    App->profiler->EndScope();
 
-    // Motor sound: play while W or S is held
+    // Sonido de motor de cada coche, sintetizado a partir de su velocidad
+    UpdateEngineSound();
+
+    // Motor-down FX when W/S is released
     bool wOrS = IsKeyDown(KEY_W) || IsKeyDown(KEY_S);
     if (wOrS)
     {
-        if (!motorPlaying && App->audio)
-        {
-            if (App->audio->PlayMotor("Assets/motor_sound.mp3"))
-            {
-                motorPlaying = true;
-            }
-        }
+        motorPlaying = true;
     }
     else
     {
         if (motorPlaying && App->audio)
         {
-            App->audio->StopMotor();
             motorPlaying = false;
             // Play motor-down FX once when motor just stopped
             if (motor_down_fx !=0)
             {
-                App->audio->PlayFx(motor_down_fx);
+                App->audio->PlayFxAt(motor_down_fx, cars.x[CAR_PLAYER], cars.y[CAR_PLAYER]);
             }
         }
     }
 
+    // ====================== MINIMAPA / VISTA GENERAL ======================
+    App->profiler->BeginScope("HUD");
+    // TAB held: whole track on screen, otherwise a minimap in the top right corner
+    if (IsKeyDown(KEY_TAB))
+    {
+        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, BLACK);
+        DrawTrackMap(Rectangle{ 0.0f, 0.0f, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT });
+    }
+    else
+    {
+        Rectangle minimap = { (float)SCREEN_WIDTH - 360.0f, 20.0f, 340.0f, 147.0f };
+        DrawRectangleRec(minimap, Color{ 0, 0, 0, 190 });
+        DrawTrackMap(minimap);
+        DrawRectangleLinesEx(minimap, 1.0f, WHITE);
+    }
+
     // ====================== HUD LEGIBLE ======================
-    int hudX = 20, hudY = 20, hudW = 460, hudH = 300;
+    int hudX = 20, hudY = 20, hudW = 460, hudH = 330;
     DrawRectangle(hudX, hudY, hudW, hudH, Color{ 0, 0, 0, 190 });
     DrawRectangleLines(hudX, hudY, hudW, hudH, WHITE);
 
@@ -1065,91 +1021,32 @@ update_status ModuleGame::Update()
     DrawText("RACE HUD", xHUD, yHUD, fsTitle, WHITE);
     yHUD += 30;
 
-    // -------- Gasolina (arreglada) --------
-    int gasPct = (int)((gasoline / (float)max_gasoline) * 100.0f);
-    if (gasPct < 0) gasPct = 0;
-    if (gasPct > 100) gasPct = 100;
-    DrawText(TextFormat("Gasolina: %d%%", gasPct), xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    // -------- Velocidad (del player) --------
-    float speedMS = 0.0f;
-    if (car && car->body && car->body->body)
-    {
-        b2Vec2 v = car->body->body->GetLinearVelocity();
-        speedMS = sqrtf(v.x * v.x + v.y * v.y);
-    }
-    float speedKMH = speedMS * 3.6f; // aproximado
-    DrawText(TextFormat("Velocidad: %.1f km/h", speedKMH), xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    // -------- Crono vuelta player --------
-    char curStr[32], bestStr[32], lastStr[32];
-    FormatTime(sPlayerLapCurrent, curStr, 32);
-    FormatTime((sPlayerLapBest >= 999998.0f) ? 0.0f : sPlayerLapBest, bestStr, 32);
-    FormatTime(sPlayerLapLast, lastStr, 32);
-
-    DrawText(TextFormat("Vuelta: %d/%d", lapCount, kMaxLaps), xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    DrawText(TextFormat("Lap:  %s", curStr), xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    DrawText(TextFormat("Best: %s", bestStr), xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    // -------- Top 3 mejores tiempos (IA) --------
-    DrawText("TOP 3 IA (best lap)", xHUD, yHUD, fs, WHITE);
-    yHUD += line;
-
-    // recolectar (aiIndex, bestTime)
-    struct AiRank { int idx; float t; };
-    std::vector<AiRank> ranking;
-    ranking.reserve(aiCars.size());
-
-    for (int i = 0; i < (int)aiCars.size(); ++i)
+    HudText hud;
+    FormatHud(hud);
+    for (int l = 0; l < hud.count; ++l)
     {
-        float t = (i < (int)sAiLapBest.size()) ? sAiLapBest[i] : 999999.0f;
-        if (t < 999998.0f) ranking.push_back({ i, t }); // solo si tienen tiempo vlido
-    }
-
-    std::sort(ranking.begin(), ranking.end(), [](const AiRank& a, const AiRank& b) {
-        return a.t < b.t;
-        });
-
-    for (int r = 0; r < 3; ++r)
-    {
-        if (r >= (int)ranking.size())
-        {
-            DrawText(TextFormat("%d) --:--.--", r + 1), xHUD, yHUD, fs, WHITE);
-            yHUD += line;
-            continue;
-        }
-
-        char tStr[32];
-        FormatTime(ranking[r].t, tStr, 32);
-        DrawText(TextFormat("%d) AI%02d  %s", r + 1, ranking[r].idx + 1, tStr), xHUD, yHUD, fs, WHITE);
+        DrawText(hud.lines[l], xHUD, yHUD, fs, hud.colors[l]);
         yHUD += line;
     }
+    App->profiler->EndScope();
+
 
 
     // ===== DEBUG: dibujar checkpoints =====
-    for (int i = 0; i < (int)checkpoints.size(); ++i)
+    for (int i = 0; i < track.GetCheckpointCount(); ++i)
     {
-        PhysBody* s = checkpoints[i];
-        int x, y;
-        s->GetPhysicPosition(x, y);
+        const TrackCheckpoint& cp = track.GetCheckpoint(i);
 
         float camX = App->renderer->camera.x;
         float camY = App->renderer->camera.y;
 
-        Color c = (i == nextCheckpoint) ? YELLOW : RED;
+        Color c = (i == cars.track[CAR_PLAYER].next_checkpoint) ? YELLOW : RED;
 
         DrawRectangleLines(
-            (int)(x + camX - s->width * 0.5f),
-            (int)(y + camY - s->height * 0.5f),
-            s->width,
-            s->height,
+            (int)(cp.x + camX - cp.width * 0.5f),
+            (int)(cp.y + camY - cp.height * 0.5f),
+            (int)cp.width,
+            (int)cp.height,
             c
         );
     }
@@ -1207,84 +1104,461 @@ update_status ModuleGame::Update()
     return UPDATE_CONTINUE;
 }
 
-void ModuleGame::OnCollision(PhysBody* bodyA, PhysBody* bodyB)
+// =====================================================================
+// PIPELINE DE COCHES: cada etapa es un bucle sobre las columnas que usa
+// =====================================================================
+void ModuleGame::FormatHud(HudText& hud) const
 {
-    if (checkpoints.empty() || car == nullptr) return;
+    hud.count = 0;
+    char dropped[HUD_LINE_LENGTH];
+    auto addLine = [&hud, &dropped](Color color) -> char*
+    {
+        // Lleno: la linea se escribe en dropped y se pierde (subir HUD_MAX_LINES)
+        assert(hud.count < HUD_MAX_LINES && "HudText full, raise HUD_MAX_LINES");
+        if (hud.count == HUD_MAX_LINES) return dropped;
+
+        hud.colors[hud.count] = color;
+        return hud.lines[hud.count++];
+    };
+
+    // -------- Gasolina (arreglada) --------
+    int gasPct = (int)((gasoline / (float)max_gasoline) * 100.0f);
+    if (gasPct < 0) gasPct = 0;
+    if (gasPct > 100) gasPct = 100;
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Gasolina: %d%%", gasPct);
+
+    // -------- Velocidad (del player) --------
+    float speedMS = 0.0f;
+    if (cars.Size() > 0)
+    {
+        b2Vec2 v = cars.body[CAR_PLAYER]->body->GetLinearVelocity();
+        speedMS = sqrtf(v.x * v.x + v.y * v.y);
+    }
+    float speedKMH = speedMS * 3.6f; // aproximado
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Velocidad: %.1f km/h", speedKMH);
+
+    // -------- Crono vuelta player --------
+    char curStr[32], bestStr[32];
+    FormatTime(cars.lap_current[CAR_PLAYER], curStr, 32);
+    FormatTime((cars.lap_best[CAR_PLAYER] >= 999998.0f) ? 0.0f : cars.lap_best[CAR_PLAYER], bestStr, 32);
+
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Vuelta: %d/%d", cars.track[CAR_PLAYER].lap, kMaxLaps);
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Lap:  %s", curStr);
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Best: %s", bestStr);
 
-    // ---------- PLAYER ----------
-    if (bodyA == car->body || bodyB == car->body)
+    // -------- Posiciones en vivo --------
+    int carCount = leaderboard.GetCarCount();
+    snprintf(addLine(WHITE), HUD_LINE_LENGTH, "Posicion: P%d/%d", leaderboard.GetPosition(0) + 1, carCount);
+
+    for (int r = 0; r < 3 && r < carCount; ++r)
     {
-        PhysBody* other = (bodyA == car->body) ? bodyB : bodyA;
+        int c = leaderboard.GetCar(r);
+        if (c == 0) snprintf(addLine(YELLOW), HUD_LINE_LENGTH, "P%d  YOU", r + 1);
+        else snprintf(addLine(WHITE), HUD_LINE_LENGTH, "P%d  AI%02d", r + 1, c);
+    }
+}
 
-        if (nextCheckpoint < 0 || nextCheckpoint >= (int)checkpoints.size())
-            nextCheckpoint = 0;
+void ModuleGame::GatherCarState()
+{
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        const b2Body* body = cars.body[i]->body;
+        const b2Transform& xf = body->GetTransform();
+
+        cars.x[i] = PIXELS_PER_METER * xf.p.x;
+        cars.y[i] = PIXELS_PER_METER * xf.p.y;
+        cars.angle[i] = body->GetAngle();
+        cars.heading_x[i] = xf.q.c;
+        cars.heading_y[i] = xf.q.s;
+    }
+}
 
-        if (other == checkpoints[nextCheckpoint])
+// Las IA en filas de kFieldAbreast sobre la trazada, desde detras del player hasta
+// completar la vuelta. Each car starts the race already past the checkpoints behind it
+void ModuleGame::SpreadField()
+{
+    int aiCount = cars.Size() - 1;
+    int rows = (aiCount + kFieldAbreast - 1) / kFieldAbreast;
+    float lapLength = racingLine.GetLength();
+    float spacing = lapLength / (float)(rows + 1);
+    if (spacing < kFieldMinSpacing)
+        LOG("%d cars on a %.0f px lap: rows only %.0f px apart", aiCount, lapLength, spacing);
+
+    for (int i = 0; i < aiCount; ++i)
+    {
+        int car = i + 1;
+        int row = i / kFieldAbreast;
+        float lane = (float)(i % kFieldAbreast - kFieldAbreast / 2) * kFieldLaneWidth;
+
+        float d = checkpointLine[0] - (float)(row + 1) * spacing;
+        while (d < 0.0f) d += lapLength;
+
+        float x, y, aheadX, aheadY;
+        racingLine.GetPoint(d, x, y);
+        racingLine.GetPoint(d + 8.0f, aheadX, aheadY);
+        float angle = atan2f(aheadY - y, aheadX - x);
+
+        // Carril: desplazado a un lado de la trazada
+        x -= sinf(angle) * lane;
+        y += cosf(angle) * lane;
+
+        b2Body* body = cars.body[car]->body;
+        body->SetTransform(b2Vec2(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y)), angle);
+        cars.body[car]->SavePreviousTransform();
+
+        // Next checkpoint the line reaches. Past the last one the car is about to
+        // start lap 0 like the grid, otherwise lap 0 starts when it crosses the line
+        TrackPosition grid;
+        grid.next_checkpoint = 0;
+        for (int c = 0; c < (int)checkpointLine.size(); ++c)
         {
-            nextCheckpoint++;
-            if (nextCheckpoint >= (int)checkpoints.size())
+            if (checkpointLine[c] > d)
             {
-                nextCheckpoint = 0;
-                lapCount++;
-                App->audio->PlayFx(bonus_fx);
-
-                if (!sRaceFinished && lapCount >= kMaxLaps)
-                {
-                    sPlayerWon = true;
-                    sAiWon = false;
-                    sRaceFinished = true;
-                    sEndTime = (float)GetTime();
-                }
-
-                // ===== TIEMPOS PLAYER =====
-                float now = (float)GetTime();
-                sPlayerLapLast = now - sPlayerLapStart;
-                if (sPlayerLapLast < sPlayerLapBest) sPlayerLapBest = sPlayerLapLast;
-                sPlayerLapStart = now;
+                grid.next_checkpoint = c;
+                break;
             }
         }
+        grid.lap = grid.next_checkpoint == 0 ? 0 : -1;
+
+        cars.grid_track[car] = grid;
+        cars.grid_line[car] = d;
+    }
+}
+
+// ---------------------- INPUT WASD (JUGADOR) ----------------------
+void ModuleGame::ReadPlayerInput()
+{
+    uchar input = 0;
+    if (IsKeyDown(KEY_W)) input |= REPLAY_INPUT_FORWARD;
+    if (IsKeyDown(KEY_S)) input |= REPLAY_INPUT_BACKWARD;
+    if (IsKeyDown(KEY_A)) input |= REPLAY_INPUT_LEFT;
+    if (IsKeyDown(KEY_D)) input |= REPLAY_INPUT_RIGHT;
+    if (IsKeyDown(KEY_SPACE)) input |= REPLAY_INPUT_BRAKE;
+
+    // Lo que se aplica es lo que se graba: the replay feeds these same bits back
+    replay.Record(input);
+    ApplyPlayerInput(input);
+}
+
+void ModuleGame::ApplyPlayerInput(uchar input)
+{
+    float forwardInput = 0.0f;
+    float steeringInput = 0.0f;
+
+    // Space hard brake
+    bool hardBrake = (input & REPLAY_INPUT_BRAKE) != 0;
+
+    if (input & REPLAY_INPUT_FORWARD) forwardInput = 1.1f;
+    if (input & REPLAY_INPUT_BACKWARD) forwardInput = -1.1f;
+    if (input & REPLAY_INPUT_LEFT) steeringInput = -1.0f;
+    if (input & REPLAY_INPUT_RIGHT) steeringInput = 1.0f;
+
+    // If hard braking, cancel forward input so we don't accelerate
+    if (hardBrake)
+        forwardInput = 0.0f;
+
+    cars.forward_input[CAR_PLAYER] = forwardInput;
+    cars.steering_input[CAR_PLAYER] = steeringInput;
+    cars.hard_brake[CAR_PLAYER] = hardBrake ? 1 : 0;
+}
+
+// ---------------------- IA SIMPLE: seguir checkP1->checkP2->... ----------------------
+void ModuleGame::UpdateAISteering()
+{
+    // AI rows are contiguous: 1..N, plus the player's row on autopilot (headless)
+    int first = cars.is_ai[CAR_PLAYER] ? CAR_PLAYER : CAR_PLAYER + 1;
+    int count = cars.Size() - first;
+    if (count <= 0) return;
+
+    // Decisions in parallel: each job reads the track (read only) and writes its own rows.
+    // Box2D only sees the result later, in UpdateCarMovement on the main thread
+    App->jobs->ParallelFor(count, kAIJobGrain, [this, first](int begin, int end)
+    {
+        UpdateAISteering(first + begin, first + end);
+    });
+}
+
+void ModuleGame::UpdateAISteering(int begin, int end)
+{
+    UpdateAIThrottle(begin, end);
+
+    // Small random chance (approx 0.5% per tick) the AI will slow down / reverse.
+    // Each car draws from its own stream, whatever thread runs it
+    for (int i = begin; i < end; ++i)
+    {
+        if (cars.rng[i].Bounded(200) == 0)
+            cars.forward_input[i] = -10.0f;
+    }
+}
+
+void ModuleGame::UpdateAIThrottle(int begin, int end)
+{
+    if (racingLine.IsLoaded())
+    {
+        float lapLength = racingLine.GetLength();
+
+        for (int i = begin; i < end; ++i)
+        {
+            float s = racingLine.Track(cars.line_distance[i], cars.x[i], cars.y[i]);
+            cars.line_distance[i] = s;
+
+            float speed = cars.speed[i];
+
+            // Se ha pasado su checkpoint (trompo, marcha atras...): volver a por el antes de seguir la trazada
+            int next = cars.track[i].next_checkpoint;
+            if (cars.recover_checkpoint[i] != next)
+            {
+                cars.recover_checkpoint[i] = -1;
+
+                float past = s - checkpointLine[next];
+                if (past > lapLength * 0.5f) past -= lapLength;
+                if (past < -lapLength * 0.5f) past += lapLength;
+                if (past > kMissedCheckpoint) cars.recover_checkpoint[i] = next;
+            }
+
+            if (cars.recover_checkpoint[i] >= 0)
+            {
+                const TrackCheckpoint& target = track.GetCheckpoint(next);
+                cars.target_x[i] = target.x;
+                cars.target_y[i] = target.y;
+                cars.forward_input[i] = (speed < kRecoverSpeed) ? 1.0f : 0.0f;
+                continue;
+            }
+
+            // Cuanto mas rapido, mas lejos mira
+            float lookAhead = kLookAhead + fabsf(speed) * kLookAheadTime * PIXELS_PER_METER;
+            racingLine.GetPoint(s + lookAhead, cars.target_x[i], cars.target_y[i]);
+
+            // Brake points are baked in the profile, the AI only has to follow it
+            float targetSpeed = racingLine.GetSpeed(s + kBrakeLead);
+            if (speed < targetSpeed) cars.forward_input[i] = 1.0f;
+            else if (speed > targetSpeed + kSpeedMargin) cars.forward_input[i] = -1.0f;
+            else cars.forward_input[i] = 0.0f;
+        }
+
+        ComputeAISteering(&cars.x[begin], &cars.y[begin], &cars.heading_x[begin], &cars.heading_y[begin],
+            &cars.target_x[begin], &cars.target_y[begin], &cars.steering_input[begin], end - begin, kLineSteer);
         return;
     }
 
-    // ---------- IA (todas) ----------
-    for (int i = 0; i < (int)aiCars.size(); ++i)
+    // Sin trazada: directo al centro del siguiente checkpoint, gas a fondo
+    for (int i = begin; i < end; ++i)
+        cars.forward_input[i] = 1.0f;
+
+    int checkpointCount = track.GetCheckpointCount();
+    if (checkpointCount == 0)
+    {
+        std::fill(cars.steering_input.begin() + begin, cars.steering_input.begin() + end, 0.0f);
+        return;
+    }
+
+    for (int i = begin; i < end; ++i)
     {
-        Box* ai = aiCars[i];
-        if (ai == nullptr) continue;
+        int idx = cars.track[i].next_checkpoint;
+        if (idx < 0 || idx >= checkpointCount) idx = 0;
+        const TrackCheckpoint& target = track.GetCheckpoint(idx);
+
+        cars.target_x[i] = target.x;
+        cars.target_y[i] = target.y;
+    }
 
-        if (bodyA == ai->body || bodyB == ai->body)
+    // Todo el bloque de golpe, varias IA por instruccion
+    ComputeAISteering(&cars.x[begin], &cars.y[begin], &cars.heading_x[begin], &cars.heading_y[begin],
+        &cars.target_x[begin], &cars.target_y[begin], &cars.steering_input[begin], end - begin);
+}
+
+// ---- REGENERATE IF INSIDE BROWN RECTANGLE (world coords) ----
+void ModuleGame::UpdateRefuel(float dt)
+{
+    if (cars.is_ai[CAR_PLAYER]) return;
+
+    float car_px = cars.x[CAR_PLAYER];
+    float car_py = cars.y[CAR_PLAYER];
+
+    const float brown1_x = 13360;
+    const float brown1_y = 5100;
+    const float brown2_x = 5800;
+    const float brown2_y = 4230;
+    const float brown_w = 300;
+    const float brown_h = 150;
+
+    bool insideBrown = false;
+    if (car_px >= brown1_x && car_px <= brown1_x + brown_w && car_py >= brown1_y && car_py <= brown1_y + brown_h)
+        insideBrown = true;
+    else if (car_px >= brown2_x && car_px <= brown2_x + brown_w && car_py >= brown2_y && car_py <= brown2_y + brown_h)
+        insideBrown = true;
+
+    const float stop_threshold = 0.05f;
+    if (insideBrown && fabsf(cars.speed[CAR_PLAYER]) < stop_threshold && cars.forward_input[CAR_PLAYER] == 0.0f)
+    {
+        gasoline += 20.0f * dt;
+        if (gasoline > (float)max_gasoline) gasoline = (float)max_gasoline;
+
+        // Play refueling FX once when starting to refuel
+        if (!refueling)
         {
-            PhysBody* other = (bodyA == ai->body) ? bodyB : bodyA;
+            refueling = true;
+            if (gasoline_fx != 0)
+                App->audio->PlayFx(gasoline_fx);
+        }
+    }
+    else
+    {
+        // if we leave the brown area or start moving, reset refueling flag
+        refueling = false;
+    }
+}
+
+// ---------------- VELOCIDAD / FRENADO / GIRO ----------------
+void ModuleGame::UpdateCarMovement(float dt)
+{
+    const float baseTurnSpeedRad = kBaseTurnSpeedDeg * DEGTORAD;
 
-            if (aiNextCP[i] < 0 || aiNextCP[i] >= (int)checkpoints.size())
-                aiNextCP[i] = 0;
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        float speedCar = cars.speed[i];
+        float forwardInput = cars.forward_input[i];
+        float steeringInput = cars.steering_input[i];
 
-            if (other == checkpoints[aiNextCP[i]])
+        // ---- ACELERAR / FRENAR ----
+        if (cars.is_ai[i])
+        {
+            if (forwardInput > 0.0f)
+            {
+                speedCar += kAcceleration * dt;
+                if (speedCar > kMaxSpeed) speedCar = kMaxSpeed;
+            }
+            else if (forwardInput < 0.0f)
             {
-                aiNextCP[i]++;
-                if (aiNextCP[i] >= (int)checkpoints.size())
-                {
-                    aiNextCP[i] = 0;
-                    aiLaps[i]++;   
-                    if (!sRaceFinished && aiLaps[i] >= kMaxLaps)
-                    {
-                        sAiWon = true;
-                        sPlayerWon = false;
-                        sRaceFinished = true;
-                        sEndTime = (float)GetTime();
-                    }
-
-                    // ===== TIEMPOS IA =====
-                    if (i < (int)sAiLapStart.size())
-                    {
-                        float now = (float)GetTime();
-                        sAiLapLast[i] = now - sAiLapStart[i];
-                        if (sAiLapLast[i] < sAiLapBest[i]) sAiLapBest[i] = sAiLapLast[i];
-                        sAiLapStart[i] = now;
-                    }
-                }
+                speedCar -= kAcceleration * dt;
+                if (speedCar < -kMaxSpeed) speedCar = -kMaxSpeed;
             }
-            return;
         }
+        else if (cars.hard_brake[i])
+        {
+            // Hard brake when player presses SPACE
+            if (speedCar > 0.0f)
+            {
+                speedCar -= kHardBrakePower * dt;
+                if (speedCar < 0.0f) speedCar = 0.0f;
+            }
+            else if (speedCar < 0.0f)
+            {
+                speedCar += kHardBrakePower * dt;
+                if (speedCar > 0.0f) speedCar = 0.0f;
+            }
+        }
+        else if (forwardInput != 0.0f && gasoline > 0.0f)
+        {
+            if (forwardInput > 0.0f)
+            {
+                speedCar += kAcceleration * dt;
+                if (speedCar > kMaxSpeed) speedCar = kMaxSpeed;
+            }
+            else
+            {
+                speedCar -= kAcceleration * dt;
+                if (speedCar < -kMaxSpeed) speedCar = -kMaxSpeed;
+            }
+
+            // Drain gasoline while player is pressing throttle
+            gasoline -= gasoline_drain_rate * dt;
+            if (gasoline < 0.0f) gasoline = 0.0f;
+        }
+        else
+        {
+            if (speedCar > 0.0f)
+            {
+                speedCar -= kBraking * dt;
+                if (speedCar < 0.0f) speedCar = 0.0f;
+            }
+            else if (speedCar < 0.0f)
+            {
+                speedCar += kBraking * dt;
+                if (speedCar > 0.0f) speedCar = 0.0f;
+            }
+        }
+
+        // ---- GIRO DEL COCHE ----
+        float angle = cars.angle[i] + steeringInput * baseTurnSpeedRad * fabsf(speedCar) * dt;
+
+        float steeringVisual = cars.steering_visual[i];
+        if (steeringInput != 0.0f)
+        {
+            steeringVisual += steeringInput * kSteerVisualSpeed * dt;
+            if (steeringVisual > kMaxSteerVisualDeg) steeringVisual = kMaxSteerVisualDeg;
+            if (steeringVisual < -kMaxSteerVisualDeg) steeringVisual = -kMaxSteerVisualDeg;
+        }
+        else
+        {
+            steeringVisual *= powf(0.85f, dt * 30.0f); // 0.85 cada 1/30 s
+        }
+
+        cars.speed[i] = speedCar;
+        cars.angle[i] = angle;
+        cars.steering_visual[i] = steeringVisual;
+
+        // ---- APLICAR A BOX2D ----
+        b2Body* body = cars.body[i]->body;
+        body->SetTransform(body->GetPosition(), angle);
+        body->SetLinearVelocity(b2Vec2(cosf(angle) * speedCar * kMoveFactor, sinf(angle) * speedCar * kMoveFactor));
     }
 }
+
+void ModuleGame::UpdateRaceProgress()
+{
+    if (track.GetCheckpointCount() == 0) return;
+
+    for (int i = 0; i < cars.Size(); ++i)
+    {
+        if (!track.Update(cars.track[i], cars.x[i], cars.y[i], cars.angle[i], (float)kCarWidth, (float)kCarHeight))
+            continue;
+
+        // Spread field: reaching lap 0 only starts the clock, that was not a whole lap
+        if (cars.track[i].lap <= 0)
+        {
+            cars.lap_start[i] = sSimTime;
+            continue;
+        }
+
+        if (i == CAR_PLAYER)
+        {
+            App->audio->PlayFx(bonus_fx);
+            TraceInstant("Player lap");
+        }
+
+        if (!sRaceFinished && cars.track[i].lap >= kMaxLaps)
+        {
+            sPlayerWon = (i == CAR_PLAYER);
+            sAiWon = (i != CAR_PLAYER);
+            sRaceFinished = true;
+            sEndTime = (float)GetTime();
+            TraceInstant("Race finished");
+
+            // La pantalla WIN/LOSE ya no actualiza los motores: se callan aqui
+            if (App->audio)
+            {
+                App->audio->SilenceEngines();
+            }
+            motorPlaying = false;
+        }
+
+        // ===== TIEMPOS =====
+        float now = sSimTime;
+        cars.lap_last[i] = now - cars.lap_start[i];
+        if (cars.lap_last[i] < cars.lap_best[i]) cars.lap_best[i] = cars.lap_last[i];
+        cars.lap_start[i] = now;
+
+        // Vuelta del player terminada: si es la mejor pasa a ser el fantasma
+        if (i == CAR_PLAYER)
+        {
+            ghost.EndLap(cars.lap_last[i]);
+            ghost.BeginLap();
+        }
+    }
+
+    // ---------- POSICIONES ----------
+    for (int i = 0; i < cars.Size(); ++i)
+        leaderboard.SetDistance(i, cars.track[i].distance);
+    leaderboard.Sort();
+}
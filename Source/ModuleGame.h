@@ -4,13 +4,46 @@
 #include "Module.h"
 #include "p2Point.h"
 #include "raylib.h"
+#include "TileMap.h"
+#include "TrackProgress.h"
+#include "Leaderboard.h"
+#include "CarTable.h"
+#include "RacingLine.h"
+#include "Replay.h"
+#include "GhostLap.h"
+#include "AssetLoader.h"
 
 #include <vector>
-#include <set>
 
 class PhysBody;
-class PhysicEntity;
-class Box;
+
+// What drawing needs from a car, copied once per frame after the simulation ticks
+enum CarSprite : unsigned char
+{
+    CAR_SPRITE_STRAIGHT,
+    CAR_SPRITE_LEFT,
+    CAR_SPRITE_RIGHT
+};
+
+// HUD lines as text, formatted once per frame apart from drawing them.
+// FormatHud() writes 9 lines today, extra ones are dropped
+#define HUD_MAX_LINES 10
+#define HUD_LINE_LENGTH 48
+
+struct HudText
+{
+    char lines[HUD_MAX_LINES][HUD_LINE_LENGTH];
+    Color colors[HUD_MAX_LINES];
+    int count = 0;
+};
+
+struct CarRenderState
+{
+    float x = 0.0f;         // map pixels
+    float y = 0.0f;
+    float angle = 0.0f;     // radians
+    CarSprite sprite = CAR_SPRITE_STRAIGHT;
+};
 
 class ModuleGame : public Module
 {
@@ -19,32 +52,83 @@ public:
     ~ModuleGame();
 
     bool Start() override;
+    update_status FixedUpdate(float dt) override;
     update_status Update() override;
     bool CleanUp() override;
-    void OnCollision(PhysBody* bodyA, PhysBody* bodyB) override;
 
-public:
-    // ---------- ENTIDADES ----------
-    std::vector<PhysicEntity*> entities;
+    // Per tick car pipeline, each stage one loop over the car table
+    void GatherCarState();
+    void ReadPlayerInput();
+    void ApplyPlayerInput(uchar input);             // REPLAY_INPUT_* bits
+    void UpdateAISteering();
+    void UpdateAISteering(int begin, int end);     // rows [begin, end), safe from any thread
+    void UpdateAIThrottle(int begin, int end);
+    void UpdateRefuel(float dt);
+    void UpdateCarMovement(float dt);
+
+    // Checkpoint / lap bookkeeping for every car, once per tick
+    void UpdateRaceProgress();
+
+    // AI cars around the whole lap instead of the grid (--cars)
+    void SpreadField();
 
-    // ---------- PLAYER ----------
-    Box* car = nullptr;
+    // Player's gasoline, speed, lap times and the standings as HUD lines
+    void FormatHud(HudText& hud) const;
 
-    // ---------- IA (N coches) ----------
-    std::vector<Box*> aiCars;     // punteros a las IA
-    std::vector<int> aiNextCP;    // next checkpoint por IA
-    std::vector<int> aiLaps;      // laps por IA
+    // Hash of every car's state, equal runs give equal hashes (replay sync check)
+    uint32 RaceChecksum() const;
+
+    // Final standings to stdout (headless runs)
+    void PrintRaceResults() const;
+
+    // Engine of each car from its speed and throttle, positioned for the voice manager
+    void UpdateEngineSound();
+
+    // Progress of the asset loader while the assets finish
+    void DrawLoadingScreen() const;
+
+    // Whole track fitted inside area (minimap / overview) with a dot per car
+    void DrawTrackMap(Rectangle area);
+
+    // Render snapshot of every car, then draw from it (off-screen cars skipped)
+    void CollectRenderState(float alpha);
+    void DrawCars() const;
+    void DrawCar(const CarRenderState& rs, Color tint) const;
+
+public:
+    // ---------- COCHES ----------
+    // Fila 0 el player, 1..N las IA
+    CarTable cars;
 
     // ---------- CHECKPOINTS ----------
-    std::vector<PhysBody*> checkpoints;
+    TrackProgress track;
 
-    // Progreso player
-    int nextCheckpoint = 0;
-    int lapCount = 0;
+    // Trazada ideal para las IA (sin ella van de checkpoint en checkpoint)
+    RacingLine racingLine;
+    std::vector<float> checkpointLine;  // distancia de cada checkpoint sobre la trazada
+
+    // Semilla de la carrera: con la misma semilla las IA toman las mismas decisiones
+    uint64 raceSeed = 0;
+
+    // Grabacion / repeticion de los controles del player
+    Replay replay;
+    bool replaySynced = false;
+
+    // Posiciones en carrera: coche 0 es el player, 1..N las IA
+    Leaderboard leaderboard;
+
+    // Estado de dibujado por coche, mismos indices
+    std::vector<CarRenderState> carRender;
+
+    // Fantasma: mejor vuelta del player, solo datos (sin body ni colisiones)
+    GhostLap ghost;
+    CarRenderState ghostRender;
+    bool ghostVisible = false;
 
     // ---------- ASSETS ----------
+    AssetLoader loader;
     Texture2D carTexture{};
-    Texture2D mapaMontmelo{};
+    TileMap mapaMontmelo;
     uint32 bonus_fx = 0;
     uint32 gasoline_fx = 0;
     uint32 motor_down_fx = 0; // FX to play when motor stops
@@ -71,11 +155,9 @@ public:
     vec2<int> ray;
     bool ray_on = false;
 
-    std::set<std::set<PhysicEntity*>> collidingEntities;
-
     // Track whether player is currently refueling (to play FX once)
     bool refueling = false;
 
-    // Track motor sound playing state (PlayMotor / StopMotor)
+    // W/S held last frame (motor-down FX on release)
     bool motorPlaying = false;
 };
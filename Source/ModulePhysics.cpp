@@ -4,6 +4,8 @@
 #include "ModulePhysics.h"
 
 #include "p2Point.h"
+#include "Profiler.h"
+#include "Trace.h"
 
 #include <math.h>
 
@@ -33,9 +35,20 @@ bool ModulePhysics::Start()
 	return true;
 }
 
-update_status ModulePhysics::PreUpdate()
+update_status ModulePhysics::FixedUpdate(float dt)
 {
-	world->Step(1.0f / 60.0f, 6, 2);
+	for(b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		PhysBody* pb = (PhysBody*)b->GetUserData().pointer;
+		if(pb) pb->SavePreviousTransform();
+	}
+
+	{
+		TRACE_SCOPE("Box2D Step");
+		ProfileScope scope(App->profiler, "Step");
+		world->Step(dt, 6, 2);
+	}
+	TraceCounter("Contacts", world->GetContactCount());
 
 	for(b2Contact* c = world->GetContactList(); c; c = c->GetNext())
 	{
@@ -74,6 +87,7 @@ PhysBody* ModulePhysics::CreateCircle(int x, int y, int radius)
 	b->CreateFixture(&fixture);
 
 	pbody->body = b;
+	pbody->SavePreviousTransform();
 	pbody->width = pbody->height = radius;
 
 	return pbody;
@@ -99,6 +113,7 @@ PhysBody* ModulePhysics::CreateCircle(int x, int y, int radius, b2Vec2 initialVe
 	b->CreateFixture(&fixture);
 
 	pbody->body = b;
+	pbody->SavePreviousTransform();
 	pbody->width = pbody->height = radius;
 	b->SetLinearVelocity(initialVelocity);
 
@@ -125,6 +140,7 @@ PhysBody* ModulePhysics::CreateRectangle(int x, int y, int width, int height)
 	b->CreateFixture(&fixture);
 
 	pbody->body = b;
+	pbody->SavePreviousTransform();
 	pbody->width = (int)(width * 0.5f);
 	pbody->height = (int)(height * 0.5f);
 
@@ -153,6 +169,7 @@ PhysBody* ModulePhysics::CreateRectangleSensor(int x, int y, int width, int heig
 	b->CreateFixture(&fixture);
 
 	pbody->body = b;
+	pbody->SavePreviousTransform();
 	pbody->width = width;
 	pbody->height = height;
 
@@ -186,9 +203,10 @@ PhysBody* ModulePhysics::CreateChain(int x, int y, const int* points, int size)
 
 	b->CreateFixture(&fixture);
 
-	delete p;
+	delete[] p;
 
 	pbody->body = b;
+	pbody->SavePreviousTransform();
 	pbody->width = pbody->height = 0;
 
 	return pbody;
@@ -202,6 +220,12 @@ void ModulePhysics::DeleteBody(PhysBody* body)
 // 
 update_status ModulePhysics::PostUpdate()
 {
+	// Nothing to draw on
+	if (App->IsHeadless())
+	{
+		return UPDATE_CONTINUE;
+	}
+
 	if (IsKeyPressed(KEY_F1))
 	{
 		debug = !debug;
@@ -233,7 +257,7 @@ update_status ModulePhysics::PostUpdate()
 				{
 					b2PolygonShape* polygonShape = (b2PolygonShape*)f->GetShape();
 					int32 count = polygonShape->m_count;
-					b2Vec2 prev, v;
+					b2Vec2 prev = b2Vec2_zero, v;
 
 					for(int32 i = 0; i < count; ++i)
 					{
@@ -252,7 +276,7 @@ update_status ModulePhysics::PostUpdate()
 				case b2Shape::e_chain:
 				{
 					b2ChainShape* shape = (b2ChainShape*)f->GetShape();
-					b2Vec2 prev, v;
+					b2Vec2 prev = b2Vec2_zero, v;
 
 					for(int32 i = 0; i < shape->m_count; ++i)
 					{
@@ -273,11 +297,14 @@ update_status ModulePhysics::PostUpdate()
 					b2EdgeShape* shape = (b2EdgeShape*)f->GetShape();
 					b2Vec2 v1, v2;
 
-					v1 = b->GetWorldPoint(shape->m_vertex0);
 					v1 = b->GetWorldPoint(shape->m_vertex1);
+					v2 = b->GetWorldPoint(shape->m_vertex2);
 					DrawLine(METERS_TO_PIXELS(v1.x), METERS_TO_PIXELS(v1.y), METERS_TO_PIXELS(v2.x), METERS_TO_PIXELS(v2.y), BLUE);
 				}
 				break;
+
+				default:
+				break;
 			}
 		}
 	}
@@ -306,6 +333,24 @@ float PhysBody::GetRotation() const
 	return body->GetAngle();
 }
 
+void PhysBody::GetInterpolatedPosition(float alpha, float& x, float& y) const
+{
+	b2Vec2 pos = body->GetPosition();
+	x = PIXELS_PER_METER * (previous_position.x + (pos.x - previous_position.x) * alpha);
+	y = PIXELS_PER_METER * (previous_position.y + (pos.y - previous_position.y) * alpha);
+}
+
+float PhysBody::GetInterpolatedRotation(float alpha) const
+{
+	return previous_angle + (body->GetAngle() - previous_angle) * alpha;
+}
+
+void PhysBody::SavePreviousTransform()
+{
+	previous_position = body->GetPosition();
+	previous_angle = body->GetAngle();
+}
+
 bool PhysBody::Contains(int x, int y) const
 {
 	b2Vec2 p(PIXEL_TO_METERS(x), PIXEL_TO_METERS(y));
@@ -3,7 +3,7 @@
 #include "Module.h"
 #include "Globals.h"
 
-#include "box2d\box2d.h"
+#include "box2d/box2d.h"
 
 #define GRAVITY_X 0.0f
 #define GRAVITY_Y -7.0f
@@ -18,12 +18,18 @@
 class PhysBody
 {
 public:
-	PhysBody() : listener(NULL), body(NULL)
+	PhysBody() : body(NULL), listener(NULL), previous_position(0.0f, 0.0f), previous_angle(0.0f)
 	{}
 
 	//void GetPosition(int& x, int& y) const;
 	void GetPhysicPosition(int& x, int &y) const;
 	float GetRotation() const;
+
+	// Render state between the last two physics ticks, alpha from Application::GetFixedAlpha()
+	void GetInterpolatedPosition(float alpha, float& x, float& y) const;
+	float GetInterpolatedRotation(float alpha) const;
+	// Called before every step, call it after teleporting a body so it does not slide there
+	void SavePreviousTransform();
 	bool Contains(int x, int y) const;
 	int RayCast(int x1, int y1, int x2, int y2, float& normal_x, float& normal_y) const;
 
@@ -31,6 +37,9 @@ public:
 	int width, height;
 	b2Body* body;
 	Module* listener;
+
+	b2Vec2 previous_position;
+	float previous_angle;
 };
 
 // Module --------------------------------------
@@ -41,7 +50,7 @@ public:
 	~ModulePhysics();
 
 	bool Start();
-	update_status PreUpdate();
+	update_status FixedUpdate(float dt);
 	update_status PostUpdate();
 	bool CleanUp();
 
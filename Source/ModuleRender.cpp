@@ -2,6 +2,7 @@
 #include "Application.h"
 #include "ModuleWindow.h"
 #include "ModuleRender.h"
+#include "Profiler.h"
 #include <math.h>
 
 ModuleRender::ModuleRender(Application* app, bool start_enabled) : Module(app, start_enabled)
@@ -40,6 +41,16 @@ update_status ModuleRender::Update()
 update_status ModuleRender::PostUpdate()
 {
     DrawFPS(10, 10);
+
+    // F3 frame profiler overlay, F4 dumps its history (--profile path, profile.json by default)
+    if (IsKeyPressed(KEY_F3)) App->profiler->ToggleOverlay();
+    if (IsKeyPressed(KEY_F4))
+    {
+        const char* path = App->GetProfilePath() != NULL ? App->GetProfilePath() : "profile.json";
+        if (!App->profiler->Dump(path)) LOG("Cannot write profile: %s", path);
+    }
+    if (App->profiler->IsOverlayVisible()) App->profiler->DrawOverlay(SCREEN_WIDTH - 340, 180);
+
     EndDrawing();
 
 	return UPDATE_CONTINUE;
@@ -57,7 +68,7 @@ void ModuleRender::SetBackgroundColor(Color color)
 }
 
 // Draw to screen
-bool ModuleRender::Draw(Texture2D texture, int x, int y, const Rectangle* section, double angle, int pivot_x, int pivot_y) const
+bool ModuleRender::Draw(Texture2D texture, int x, int y, const Rectangle* section, double /*angle*/, int pivot_x, int pivot_y) const
 {
 	bool ret = true;
 
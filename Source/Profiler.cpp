@@ -0,0 +1,291 @@
+#include "Profiler.h"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static_assert(PROFILER_MAX_TICKS * FIXED_TIMESTEP >= MAX_FRAME_TIME, "PROFILER_MAX_TICKS below the ticks of a catch-up frame");
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+Profiler::Profiler()
+{
+	frames.resize(PROFILER_HISTORY);
+	newest = PROFILER_HISTORY - 1;
+	count = 0;
+	frame_index = 0;
+	in_frame = false;
+	depth = 0;
+	overlay = false;
+}
+
+Profiler::~Profiler()
+{
+}
+
+double Profiler::Now() const
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::BeginFrame()
+{
+	// History full: the oldest frame makes room for this one
+	if (count == PROFILER_HISTORY) count--;
+	newest = (newest + 1) % PROFILER_HISTORY;
+
+	Frame& frame = frames[newest];
+	frame.index = frame_index++;
+	frame.start_us = Now();
+	frame.duration_us = 0.0f;
+	frame.scope_count = 0;
+	frame.dropped = 0;
+
+	in_frame = true;
+	depth = 0;
+}
+
+void Profiler::EndFrame()
+{
+	if (!in_frame) return;
+
+	// Scopes left open end with the frame
+	while (depth > 0) EndScope();
+
+	Frame& frame = frames[newest];
+	frame.duration_us = (float)(Now() - frame.start_us);
+
+	in_frame = false;
+	count++;
+}
+
+void Profiler::BeginScope(const char* name, const char* detail)
+{
+	if (!in_frame) return;
+
+	// Full frame or too deep: counted as open so EndScope() still pairs, dropped and not recorded
+	Frame& frame = frames[newest];
+	int index = -1;
+	if (frame.scope_count < PROFILER_MAX_SCOPES && depth < PROFILER_MAX_DEPTH)
+	{
+		index = frame.scope_count++;
+		Scope& scope = frame.scopes[index];
+		scope.name = name;
+		scope.detail = detail;
+		scope.depth = depth;
+		scope.start_us = (float)(Now() - frame.start_us);
+		scope.duration_us = 0.0f;
+	}
+	else
+	{
+		frame.dropped++;
+	}
+
+	if (depth < PROFILER_MAX_DEPTH) open[depth] = index;
+	depth++;
+}
+
+void Profiler::EndScope()
+{
+	if (!in_frame || depth == 0) return;
+
+	depth--;
+	if (depth >= PROFILER_MAX_DEPTH || open[depth] < 0) return;
+
+	Frame& frame = frames[newest];
+	Scope& scope = frame.scopes[open[depth]];
+	scope.duration_us = (float)(Now() - frame.start_us) - scope.start_us;
+}
+
+int Profiler::GetFrameCount() const
+{
+	return count;
+}
+
+const Profiler::Frame& Profiler::GetFrame(int i) const
+{
+	// The frame being recorded is not part of the history yet
+	int last = in_frame ? newest - 1 : newest;
+	return frames[(last - (count - 1) + i + 2 * PROFILER_HISTORY) % PROFILER_HISTORY];
+}
+
+void Profiler::GetFrameStats(float& min_ms, float& avg_ms, float& p99_ms) const
+{
+	min_ms = avg_ms = p99_ms = 0.0f;
+	if (count == 0) return;
+
+	float sorted[PROFILER_HISTORY];
+	double total = 0.0;
+	for (int i = 0; i < count; ++i)
+	{
+		sorted[i] = GetFrame(i).duration_us;
+		total += sorted[i];
+	}
+
+	int p99 = (count * 99) / 100;
+	if (p99 >= count) p99 = count - 1;
+	std::nth_element(sorted, sorted + p99, sorted + count);
+
+	min_ms = *std::min_element(sorted, sorted + count) / 1000.0f;
+	avg_ms = (float)total / count / 1000.0f;
+	p99_ms = sorted[p99] / 1000.0f;
+}
+
+int Profiler::GetDroppedScopes() const
+{
+	int dropped = 0;
+	for (int i = 0; i < count; ++i)
+		dropped += GetFrame(i).dropped;
+	return dropped;
+}
+
+float Profiler::AverageScope(const char* name, const char* detail) const
+{
+	if (count == 0) return 0.0f;
+
+	double total = 0.0;
+	for (int i = 0; i < count; ++i)
+	{
+		const Frame& frame = GetFrame(i);
+		for (int s = 0; s < frame.scope_count; ++s)
+		{
+			if (frame.scopes[s].name == name && frame.scopes[s].detail == detail)
+				total += frame.scopes[s].duration_us;
+		}
+	}
+
+	return (float)total / count / 1000.0f;
+}
+
+void Profiler::ToggleOverlay()
+{
+	overlay = !overlay;
+}
+
+bool Profiler::IsOverlayVisible() const
+{
+	return overlay;
+}
+
+void Profiler::DrawOverlay(int x, int y) const
+{
+	const int graph_w = PROFILER_HISTORY;
+	const int graph_h = 80;
+	const float graph_ms = 50.0f;      // top of the graph
+	const int fs = 10;
+	const int line = 12;
+
+	float min_ms, avg_ms, p99_ms;
+	GetFrameStats(min_ms, avg_ms, p99_ms);
+
+	// Scope list: the names of the last frame, averaged over the whole history
+	const Frame* last = count > 0 ? &GetFrame(count - 1) : NULL;
+	int rows = last != NULL ? last->scope_count : 0;
+	int panel_h = graph_h + 30 + rows * line;
+
+	DrawRectangle(x, y, graph_w + 20, panel_h, Color{ 0, 0, 0, 200 });
+
+	DrawText(TextFormat("frame  min %.2f  avg %.2f  p99 %.2f ms", min_ms, avg_ms, p99_ms), x + 10, y + 6, fs, WHITE);
+
+	// Frames that lost scopes under-report, say so
+	int dropped = GetDroppedScopes();
+	if (dropped > 0) DrawText(TextFormat("%d scopes dropped", dropped), x + graph_w - 90, y + 6, fs, RED);
+
+	// One bar per frame, newest on the right, with the avg / p99 levels across
+	int gx = x + 10;
+	int gy = y + 20;
+	for (int i = 0; i < count; ++i)
+	{
+		float ms = GetFrame(i).duration_us / 1000.0f;
+		int h = (int)(MIN(ms, graph_ms) / graph_ms * graph_h);
+		Color color = ms > 1000.0f / 30.0f ? RED : (ms > 1000.0f / 60.0f + 1.0f ? ORANGE : GREEN);
+		DrawLine(gx + graph_w - count + i, gy + graph_h, gx + graph_w - count + i, gy + graph_h - h, color);
+	}
+
+	int avg_y = gy + graph_h - (int)(MIN(avg_ms, graph_ms) / graph_ms * graph_h);
+	int p99_y = gy + graph_h - (int)(MIN(p99_ms, graph_ms) / graph_ms * graph_h);
+	DrawLine(gx, avg_y, gx + graph_w, avg_y, SKYBLUE);
+	DrawLine(gx, p99_y, gx + graph_w, p99_y, MAGENTA);
+	DrawRectangleLines(gx, gy, graph_w, graph_h, GRAY);
+
+	int ty = gy + graph_h + 6;
+	for (int s = 0; s < rows; ++s)
+	{
+		const Scope& scope = last->scopes[s];
+
+		// The same scope several times in a frame (fixed ticks) is listed once
+		bool repeated = false;
+		for (int p = 0; p < s && !repeated; ++p)
+			repeated = last->scopes[p].name == scope.name && last->scopes[p].detail == scope.detail;
+		if (repeated) continue;
+
+		const char* label = scope.detail != NULL ? TextFormat("%s %s", scope.name, scope.detail) : scope.name;
+		DrawText(TextFormat("%*s%s", scope.depth * 2, "", label), gx, ty, fs, WHITE);
+		DrawText(TextFormat("%6.2f ms", AverageScope(scope.name, scope.detail)), gx + graph_w - 60, ty, fs, WHITE);
+		ty += line;
+	}
+}
+
+bool Profiler::Dump(const char* path) const
+{
+	size_t length = strlen(path);
+	if (length >= 5 && strcmp(path + length - 5, ".json") == 0) return DumpChromeTrace(path);
+	return DumpCSV(path);
+}
+
+bool Profiler::DumpCSV(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL) return false;
+
+	// One row per scope, the frame itself is the depth -1 row and carries the scopes it dropped
+	fprintf(file, "frame,scope,depth,start_us,duration_us,dropped\n");
+	for (int i = 0; i < count; ++i)
+	{
+		const Frame& frame = GetFrame(i);
+		fprintf(file, "%llu,Frame,-1,0,%.3f,%d\n", (unsigned long long)frame.index, frame.duration_us, frame.dropped);
+
+		for (int s = 0; s < frame.scope_count; ++s)
+		{
+			const Scope& scope = frame.scopes[s];
+			fprintf(file, "%llu,%s%s%s,%d,%.3f,%.3f,0\n", (unsigned long long)frame.index, scope.name,
+				scope.detail != NULL ? "." : "", scope.detail != NULL ? scope.detail : "",
+				scope.depth, scope.start_us, scope.duration_us);
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool Profiler::DumpChromeTrace(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL) return false;
+
+	// Complete ("X") events on one thread, chrome://tracing and Perfetto nest them by time
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool first = true;
+	for (int i = 0; i < count; ++i)
+	{
+		const Frame& frame = GetFrame(i);
+		fprintf(file, "%s{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu,\"dropped_scopes\":%d}}",
+			first ? "" : ",\n", frame.start_us, frame.duration_us, (unsigned long long)frame.index, frame.dropped);
+		first = false;
+
+		for (int s = 0; s < frame.scope_count; ++s)
+		{
+			const Scope& scope = frame.scopes[s];
+			fprintf(file, ",\n{\"name\":\"%s%s%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+				scope.name, scope.detail != NULL ? "." : "", scope.detail != NULL ? scope.detail : "",
+				frame.start_us + scope.start_us, scope.duration_us);
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <vector>
+
+#define PROFILER_HISTORY 300            // frames kept, 5 s at 60 FPS
+#define PROFILER_MAX_TICKS 16           // fixed ticks of a catch-up frame, MAX_FRAME_TIME / FIXED_TIMESTEP
+#define PROFILER_SCOPES_PER_TICK 16     // Tick, FixedUpdate of each module and the game stages (10 today)
+#define PROFILER_SCOPES_PER_FRAME 64    // module phases and drawing (18 today)
+#define PROFILER_MAX_DEPTH 16
+
+// Per frame, enough for the longest catch-up frame. Any extra scope is dropped and counted
+#define PROFILER_MAX_SCOPES (PROFILER_SCOPES_PER_FRAME + PROFILER_MAX_TICKS * PROFILER_SCOPES_PER_TICK)
+
+// Frame profiler: nested timed scopes, main thread only. Every frame is kept in a
+// ring buffer of the last PROFILER_HISTORY frames, from which the overlay draws the
+// frame time graph and the per scope averages and the dumps write CSV or Chrome
+// trace events. Scope names are string literals, stored as pointers
+class Profiler
+{
+public:
+	struct Scope
+	{
+		const char* name;
+		const char* detail;     // optional second part of the name (module phase), NULL if none
+		int depth;
+		float start_us;         // from the frame start
+		float duration_us;
+	};
+
+	struct Frame
+	{
+		uint64 index = 0;
+		double start_us = 0.0;  // from the profiler creation
+		float duration_us = 0.0f;
+		int scope_count = 0;
+		int dropped = 0;        // scopes past PROFILER_MAX_SCOPES or PROFILER_MAX_DEPTH, not recorded
+		Scope scopes[PROFILER_MAX_SCOPES];
+	};
+
+	Profiler();
+	~Profiler();
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginScope(const char* name, const char* detail = NULL);
+	void EndScope();
+
+	// Frames in the history, 0 the oldest
+	int GetFrameCount() const;
+	const Frame& GetFrame(int i) const;
+
+	// Over the history, milliseconds
+	void GetFrameStats(float& min_ms, float& avg_ms, float& p99_ms) const;
+	// Scopes dropped over the history, the frames that lost some under-report
+	int GetDroppedScopes() const;
+
+	void ToggleOverlay();
+	bool IsOverlayVisible() const;
+	void DrawOverlay(int x, int y) const;
+
+	// Whole history to path: Chrome trace events if it ends in .json, CSV otherwise
+	bool Dump(const char* path) const;
+	bool DumpCSV(const char* path) const;
+	bool DumpChromeTrace(const char* path) const;
+
+private:
+	double Now() const;
+	// Average of a scope over the history, ms per frame (scopes seen twice in a frame add up)
+	float AverageScope(const char* name, const char* detail) const;
+
+private:
+	std::vector<Frame> frames;
+	int newest;                 // ring position of the frame being recorded
+	int count;
+	uint64 frame_index;
+	bool in_frame;
+
+	int open[PROFILER_MAX_DEPTH];   // scope indices of the open scopes
+	int depth;
+
+	bool overlay;
+};
+
+// Times the enclosing block
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler* profiler, const char* name, const char* detail = NULL) : profiler(profiler)
+	{
+		profiler->BeginScope(name, detail);
+	}
+
+	~ProfileScope()
+	{
+		profiler->EndScope();
+	}
+
+private:
+	Profiler* profiler;
+};
@@ -0,0 +1,131 @@
+#include "RacingLine.h"
+
+#include <math.h>
+#include <stdio.h>
+
+RacingLine::RacingLine()
+{
+	spacing = 0.0f;
+	length = 0.0f;
+}
+
+RacingLine::~RacingLine()
+{
+}
+
+bool RacingLine::Load(const char* path)
+{
+	Unload();
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) return false;
+
+	RacingLineHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1
+		&& header.magic == RACING_LINE_MAGIC && header.version == RACING_LINE_VERSION
+		&& header.sample_count >= 3 && header.spacing > 0.0f;
+
+	if (ok)
+	{
+		samples.resize(header.sample_count);
+		ok = fread(samples.data(), sizeof(RacingLineSample), samples.size(), file) == samples.size();
+	}
+
+	fclose(file);
+
+	if (!ok)
+	{
+		Unload();
+		return false;
+	}
+
+	spacing = header.spacing;
+	length = spacing * (float)samples.size();
+
+	return true;
+}
+
+void RacingLine::Unload()
+{
+	samples.clear();
+	spacing = 0.0f;
+	length = 0.0f;
+}
+
+bool RacingLine::IsLoaded() const
+{
+	return !samples.empty();
+}
+
+int RacingLine::GetSampleCount() const
+{
+	return (int)samples.size();
+}
+
+float RacingLine::GetLength() const
+{
+	return length;
+}
+
+const RacingLineSample& RacingLine::Sample(int index) const
+{
+	int count = (int)samples.size();
+	index %= count;
+	if (index < 0) index += count;
+	return samples[index];
+}
+
+float RacingLine::Track(float hint, float x, float y) const
+{
+	int index = (int)floorf(hint / spacing);
+
+	// Walk towards the closest sample, whichever way it is
+	const RacingLineSample* s = &Sample(index);
+	float best = (s->x - x) * (s->x - x) + (s->y - y) * (s->y - y);
+
+	for (int step = 1; step >= -1; step -= 2)
+	{
+		for (;;)
+		{
+			const RacingLineSample& next = Sample(index + step);
+			float d = (next.x - x) * (next.x - x) + (next.y - y) * (next.y - y);
+			if (d >= best) break;
+
+			best = d;
+			index += step;
+		}
+	}
+
+	// Project on the segment that leaves the closest sample
+	const RacingLineSample& a = Sample(index);
+	const RacingLineSample& b = Sample(index + 1);
+	float t = ((x - a.x) * (b.x - a.x) + (y - a.y) * (b.y - a.y)) / (spacing * spacing);
+	if (t < 0.0f) t = 0.0f;
+	if (t > 1.0f) t = 1.0f;
+
+	float distance = fmodf(((float)index + t) * spacing, length);
+	if (distance < 0.0f) distance += length;
+
+	return distance;
+}
+
+void RacingLine::GetPoint(float distance, float& x, float& y) const
+{
+	float position = distance / spacing;
+	int index = (int)floorf(position);
+	float t = position - (float)index;
+
+	const RacingLineSample& a = Sample(index);
+	const RacingLineSample& b = Sample(index + 1);
+	x = a.x + (b.x - a.x) * t;
+	y = a.y + (b.y - a.y) * t;
+}
+
+float RacingLine::GetSpeed(float distance) const
+{
+	float position = distance / spacing;
+	int index = (int)floorf(position);
+	float t = position - (float)index;
+
+	return Sample(index).speed + (Sample(index + 1).speed - Sample(index).speed) * t;
+}
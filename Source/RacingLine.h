@@ -0,0 +1,59 @@
+#pragma once
+
+// Racing line: a smooth closed path through the checkpoints with the speed the
+// AI can carry at every point, baked offline by Tools/RacingLineBaker.
+// Layout on disk: RacingLineHeader, then sample_count RacingLineSample evenly
+// spaced along the line (sample i is at distance i * spacing from the start).
+//
+// Shared with the baker, no raylib here.
+
+#include <stdint.h>
+#include <vector>
+
+#define RACING_LINE_MAGIC 0x4E494C52 // "RLIN"
+#define RACING_LINE_VERSION 1
+
+struct RacingLineHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sample_count;
+	float spacing;            // map pixels between samples
+};
+
+struct RacingLineSample
+{
+	float x, y;               // map pixels
+	float curvature;          // 1 / pixels, positive turning right (y down)
+	float speed;              // target speed, body units (m/s), braking zones included
+};
+
+class RacingLine
+{
+public:
+	RacingLine();
+	~RacingLine();
+
+	bool Load(const char* path);
+	void Unload();
+
+	bool IsLoaded() const;
+	int GetSampleCount() const;
+	float GetLength() const;
+
+	// Distance along the line closest to (x, y), searching from hint: a car never
+	// moves far between ticks, so this is a few steps instead of a scan
+	float Track(float hint, float x, float y) const;
+
+	// Point and target speed at any distance (wraps around the lap), lerp of the two nearest samples
+	void GetPoint(float distance, float& x, float& y) const;
+	float GetSpeed(float distance) const;
+
+private:
+	const RacingLineSample& Sample(int index) const;
+
+private:
+	std::vector<RacingLineSample> samples;
+	float spacing;
+	float length;
+};
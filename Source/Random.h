@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Globals.h"
+
+// PCG32 (O'Neill, pcg-random.org): 64 bit LCG state, 32 bit permuted output.
+// Every (seed, stream) pair is an independent sequence, so each car owns one:
+// no shared state, safe from any thread, and the same seed replays the same race
+class Pcg32
+{
+public:
+	Pcg32()
+	{
+		Seed(0, 0);
+	}
+
+	void Seed(uint64 seed, uint64 stream)
+	{
+		state = 0;
+		increment = (stream << 1) | 1;
+		Next();
+		state += seed;
+		Next();
+	}
+
+	uint32 Next()
+	{
+		uint64 old = state;
+		state = old * 6364136223846793005ULL + increment;
+
+		uint32 xorshifted = (uint32)(((old >> 18) ^ old) >> 27);
+		uint32 rotation = (uint32)(old >> 59);
+		return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+	}
+
+	// Uniform in [0, bound), no modulo bias
+	uint32 Bounded(uint32 bound)
+	{
+		uint32 threshold = (0u - bound) % bound;
+		for (;;)
+		{
+			uint32 r = Next();
+			if (r >= threshold) return r % bound;
+		}
+	}
+
+	// Uniform in [0, 1)
+	float NextFloat()
+	{
+		return (Next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+private:
+	uint64 state;
+	uint64 increment;
+};
@@ -0,0 +1,181 @@
+#include "Replay.h"
+
+#include <stdio.h>
+
+Replay::Replay()
+{
+	Clear();
+}
+
+Replay::~Replay()
+{
+}
+
+void Replay::Clear()
+{
+	runs.clear();
+	seed = 0;
+	tick_count = 0;
+	checksum = 0;
+	recording = false;
+	playing = false;
+	tick = 0;
+	run = 0;
+	run_tick = 0;
+}
+
+void Replay::BeginRecording(uint64 race_seed)
+{
+	Clear();
+	seed = race_seed;
+	recording = true;
+}
+
+void Replay::Record(uchar input)
+{
+	if (!recording) return;
+
+	if (!runs.empty() && runs.back().input == input) runs.back().ticks++;
+	else runs.push_back(Run{ input, 1 });
+
+	tick_count++;
+	tick++;
+}
+
+bool Replay::Save(const char* path, uint32 state_checksum) const
+{
+	std::vector<uchar> data;
+	data.reserve(runs.size() * 2);
+
+	for (const Run& r : runs)
+	{
+		data.push_back(r.input);
+
+		uint32 ticks = r.ticks;
+		while (ticks >= 0x80)
+		{
+			data.push_back((uchar)(ticks | 0x80));
+			ticks >>= 7;
+		}
+		data.push_back((uchar)ticks);
+	}
+
+	ReplayHeader header = {};
+	header.magic = REPLAY_MAGIC;
+	header.version = REPLAY_VERSION;
+	header.seed = seed;
+	header.tick_count = tick_count;
+	header.run_count = (uint32)runs.size();
+	header.checksum = state_checksum;
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(data.data(), 1, data.size(), file) == data.size();
+
+	fclose(file);
+	return ok;
+}
+
+bool Replay::Load(const char* path)
+{
+	Clear();
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) return false;
+
+	ReplayHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1
+		&& header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION;
+
+	// Decode the runs, their lengths must add up to the header tick count
+	uint32 total = 0;
+	for (uint32 i = 0; ok && i < header.run_count; ++i)
+	{
+		int input = fgetc(file);
+		uint32 ticks = 0;
+		int shift = 0;
+		int c = 0;
+		do
+		{
+			c = fgetc(file);
+			if (c == EOF || shift > 28) { ok = false; break; }
+			ticks |= (uint32)(c & 0x7F) << shift;
+			shift += 7;
+		} while (c & 0x80);
+
+		if (input == EOF || ticks == 0) ok = false;
+		if (ok)
+		{
+			runs.push_back(Run{ (uchar)input, ticks });
+			total += ticks;
+		}
+	}
+
+	fclose(file);
+
+	if (!ok || total != header.tick_count)
+	{
+		Clear();
+		return false;
+	}
+
+	seed = header.seed;
+	tick_count = header.tick_count;
+	checksum = header.checksum;
+	playing = true;
+
+	return true;
+}
+
+bool Replay::Next(uchar& input)
+{
+	if (!playing || run >= runs.size()) return false;
+
+	input = runs[run].input;
+	tick++;
+
+	if (++run_tick >= runs[run].ticks)
+	{
+		run++;
+		run_tick = 0;
+	}
+
+	return true;
+}
+
+bool Replay::IsRecording() const
+{
+	return recording;
+}
+
+bool Replay::IsPlaying() const
+{
+	return playing;
+}
+
+bool Replay::IsFinished() const
+{
+	return playing && tick >= tick_count;
+}
+
+uint64 Replay::GetSeed() const
+{
+	return seed;
+}
+
+uint32 Replay::GetTickCount() const
+{
+	return tick_count;
+}
+
+uint32 Replay::GetTick() const
+{
+	return tick;
+}
+
+uint32 Replay::GetChecksum() const
+{
+	return checksum;
+}
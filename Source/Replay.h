@@ -0,0 +1,81 @@
+#pragma once
+
+// Race recording: the race seed plus the player's controls of every simulation tick.
+// The AI and the physics are deterministic for a given seed, so feeding the same
+// controls back re-runs the same race, windowed or headless.
+// Layout on disk: ReplayHeader, then run_count runs of identical ticks, each one
+// the input bits (1 byte) and the tick count as a LEB128 varint. Keys are held for
+// many ticks, so a whole race is a few KB.
+
+#include "Globals.h"
+
+#include <vector>
+
+#define REPLAY_MAGIC 0x594C5052 // "RPLY"
+#define REPLAY_VERSION 1
+
+// Player input bits, one byte per tick
+#define REPLAY_INPUT_FORWARD 0x01
+#define REPLAY_INPUT_BACKWARD 0x02
+#define REPLAY_INPUT_LEFT 0x04
+#define REPLAY_INPUT_RIGHT 0x08
+#define REPLAY_INPUT_BRAKE 0x10
+
+struct ReplayHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint64 seed;
+	uint32 tick_count;
+	uint32 run_count;
+	uint32 checksum;          // race state after the last tick, to catch desyncs on playback
+	uint32 reserved;
+};
+
+class Replay
+{
+public:
+	Replay();
+	~Replay();
+
+	// Recording
+	void BeginRecording(uint64 seed);
+	void Record(uchar input);
+	bool Save(const char* path, uint32 checksum) const;
+
+	// Playback
+	bool Load(const char* path);
+	// Input of the next tick, false once the recording is over
+	bool Next(uchar& input);
+
+	void Clear();
+
+	bool IsRecording() const;
+	bool IsPlaying() const;
+	bool IsFinished() const;      // playing and every tick consumed
+
+	uint64 GetSeed() const;
+	uint32 GetTickCount() const;
+	uint32 GetTick() const;       // ticks recorded / played so far
+	uint32 GetChecksum() const;
+
+private:
+	struct Run
+	{
+		uchar input;
+		uint32 ticks;
+	};
+
+	std::vector<Run> runs;
+	uint64 seed;
+	uint32 tick_count;
+	uint32 checksum;
+
+	bool recording;
+	bool playing;
+
+	// Playback cursor
+	uint32 tick;
+	uint32 run;
+	uint32 run_tick;
+};
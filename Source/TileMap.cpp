@@ -0,0 +1,345 @@
+#include "Globals.h"
+#include "TileMap.h"
+#include "Trace.h"
+
+#include "raylib.h"
+
+#include <math.h>
+#include <string.h>
+
+TileMap::TileMap()
+{
+	tile_size = MAP_TILE_SIZE;
+	pixel_format = 0;
+	bytes_per_pixel = 0;
+	frame = 0;
+	prefetched = 0;
+}
+
+TileMap::~TileMap()
+{
+}
+
+bool TileMap::Load(const char* path, int _tile_size, int max_resident)
+{
+	Unload();
+
+	Image source = LoadImage(path);
+	if (source.data == NULL)
+	{
+		LOG("Cannot load map: %s", path);
+		return false;
+	}
+
+	if (source.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB)
+	{
+		LOG("Map %s uses a compressed pixel format, tiles need raw pixels", path);
+		UnloadImage(source);
+		return false;
+	}
+
+	tile_size = _tile_size;
+	pixel_format = source.format;
+	bytes_per_pixel = GetPixelDataSize(1, 1, source.format);
+
+	AddLevel(source.width, source.height);
+	levels.back().image = source;
+
+	// Rest of the pyramid, halving the previous level until it fits in a single tile
+	while (levels.back().width > tile_size || levels.back().height > tile_size)
+	{
+		Image half = ImageCopy(levels.back().image);
+		ImageResize(&half, MAX(1, (half.width + 1) / 2), MAX(1, (half.height + 1) / 2));
+
+		AddLevel(half.width, half.height);
+		levels.back().image = half;
+	}
+
+	const Level& last = levels.back();
+	tile_slot.assign(last.first_tile + last.tiles_x * last.tiles_y, -1);
+	slots.assign(max_resident, TileSlot());
+	scratch.resize((size_t)tile_size * tile_size * bytes_per_pixel);
+
+	LOG("Map %s: %dx%d in %d levels of %d px tiles (%d resident max)", path, levels[0].width, levels[0].height, (int)levels.size(), tile_size, max_resident);
+
+	return true;
+}
+
+bool TileMap::LoadPack(const char* path, int max_resident)
+{
+	Unload();
+
+	if (!pack.Open(path))
+	{
+		LOG("Cannot open map tile pack: %s", path);
+		return false;
+	}
+
+	// The pack checked its own layout, the payloads must also hold a full tile of
+	// a format raylib knows: the upload reads tile_size x tile_size pixels from them
+	const TilePackHeader& header = pack.GetHeader();
+	int format = (int)header.pixel_format;
+	int tile = (int)header.tile_size;
+	if (format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE || format > PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA ||
+		(uint64)GetPixelDataSize(tile, tile, format) != pack.GetTileBytes())
+	{
+		LOG("Map tile pack %s: bad pixel format %d or tile size", path, format);
+		pack.Close();
+		return false;
+	}
+
+	tile_size = tile;
+	pixel_format = format;
+	bytes_per_pixel = 0;
+
+	for (uint32_t i = 0; i < header.level_count; ++i)
+	{
+		AddLevel((int)header.levels[i].width, (int)header.levels[i].height);
+		levels.back().first_tile = (int)header.levels[i].first_entry;
+	}
+
+	tile_slot.assign(header.tile_count, -1);
+	slots.assign(max_resident, TileSlot());
+
+	LOG("Map pack %s: %dx%d in %d levels of %d px tiles (%d resident max)", path, levels[0].width, levels[0].height, (int)levels.size(), tile_size, max_resident);
+
+	return true;
+}
+
+void TileMap::Unload()
+{
+	for (TileSlot& slot : slots)
+	{
+		if (slot.texture.id != 0) UnloadTexture(slot.texture);
+	}
+	slots.clear();
+	tile_slot.clear();
+	scratch.clear();
+	scratch.shrink_to_fit();
+
+	for (Level& level : levels)
+	{
+		if (level.image.data != NULL) UnloadImage(level.image);
+	}
+	levels.clear();
+
+	pack.Close();
+}
+
+void TileMap::AddLevel(int level_width, int level_height)
+{
+	Level level;
+	level.width = level_width;
+	level.height = level_height;
+	level.tiles_x = (level_width + tile_size - 1) / tile_size;
+	level.tiles_y = (level_height + tile_size - 1) / tile_size;
+
+	if (!levels.empty())
+	{
+		const Level& prev = levels.back();
+		level.first_tile = prev.first_tile + prev.tiles_x * prev.tiles_y;
+		level.scale_x = (float)levels[0].width / (float)level_width;
+		level.scale_y = (float)levels[0].height / (float)level_height;
+	}
+
+	levels.push_back(level);
+}
+
+bool TileMap::IsLoaded() const
+{
+	return !levels.empty();
+}
+
+int TileMap::GetWidth() const
+{
+	return levels.empty() ? 0 : levels[0].width;
+}
+
+int TileMap::GetHeight() const
+{
+	return levels.empty() ? 0 : levels[0].height;
+}
+
+int TileMap::GetLevelCount() const
+{
+	return (int)levels.size();
+}
+
+int TileMap::GetResidentTiles() const
+{
+	int count = 0;
+	for (const TileSlot& slot : slots)
+	{
+		if (slot.tile >= 0) count++;
+	}
+	return count;
+}
+
+void TileMap::BeginFrame()
+{
+	frame++;
+	prefetched = 0;
+}
+
+void TileMap::Draw(float camera_x, float camera_y, float scale)
+{
+	Draw(Rectangle{ 0.0f, 0.0f, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT }, camera_x, camera_y, scale);
+}
+
+void TileMap::Draw(Rectangle viewport, float camera_x, float camera_y, float scale)
+{
+	if (!IsLoaded() || scale <= 0.0f) return;
+
+	int level = SelectLevel(scale);
+	const Level& lv = levels[level];
+
+	// Screen size of a tile of this level
+	float tile_w = (float)tile_size * lv.scale_x * scale;
+	float tile_h = (float)tile_size * lv.scale_y * scale;
+
+	int first_x = (int)floorf((viewport.x - camera_x) / tile_w);
+	int first_y = (int)floorf((viewport.y - camera_y) / tile_h);
+	int last_x = (int)floorf((viewport.x + viewport.width - camera_x) / tile_w);
+	int last_y = (int)floorf((viewport.y + viewport.height - camera_y) / tile_h);
+
+	for (int ty = MAX(first_y, 0); ty <= MIN(last_y, lv.tiles_y - 1); ++ty)
+	{
+		for (int tx = MAX(first_x, 0); tx <= MIN(last_x, lv.tiles_x - 1); ++tx)
+		{
+			int slot = Acquire(level, tx, ty, false);
+			if (slot < 0) continue;
+
+			int w = MIN(tile_size, lv.width - tx * tile_size);
+			int h = MIN(tile_size, lv.height - ty * tile_size);
+
+			Rectangle src = { 0.0f, 0.0f, (float)w, (float)h };
+			Rectangle dst = { camera_x + tx * tile_w, camera_y + ty * tile_h, w * lv.scale_x * scale, h * lv.scale_y * scale };
+			DrawTexturePro(slots[slot].texture, src, dst, Vector2{ 0.0f, 0.0f }, 0.0f, WHITE);
+		}
+	}
+
+	// Warm up the ring around the viewport so moving into a new tile does not stall
+	for (int ty = first_y - 1; ty <= last_y + 1; ++ty)
+	{
+		for (int tx = first_x - 1; tx <= last_x + 1; ++tx)
+		{
+			if (tx < 0 || ty < 0 || tx >= lv.tiles_x || ty >= lv.tiles_y) continue;
+			if (tx >= first_x && tx <= last_x && ty >= first_y && ty <= last_y) continue;
+			Acquire(level, tx, ty, true);
+		}
+	}
+}
+
+int TileMap::SelectLevel(float scale) const
+{
+	// Coarsest level whose pixels are still not bigger than a screen pixel
+	float map_pixels_per_screen_pixel = 1.0f / scale;
+
+	int level = 0;
+	while (level + 1 < (int)levels.size() && levels[level + 1].scale_x <= map_pixels_per_screen_pixel)
+		level++;
+
+	return level;
+}
+
+int TileMap::Acquire(int level, int tile_x, int tile_y, bool prefetch)
+{
+	const Level& lv = levels[level];
+	int tile = lv.first_tile + tile_y * lv.tiles_x + tile_x;
+	int slot = tile_slot[tile];
+
+	if (slot >= 0)
+	{
+		if (!prefetch) slots[slot].last_used = frame;
+		return slot;
+	}
+
+	if (prefetch && prefetched >= MAP_PREFETCH_PER_FRAME) return -1;
+
+	// Least recently used slot. Tiles drawn this frame are never evicted,
+	// prefetching does not evict the tiles drawn last frame either
+	uint64 keep_from = prefetch ? frame - 1 : frame;
+	int victim = -1;
+	for (int i = 0; i < (int)slots.size(); ++i)
+	{
+		if (slots[i].tile >= 0 && slots[i].last_used >= keep_from) continue;
+		if (victim < 0 || slots[i].last_used < slots[victim].last_used) victim = i;
+	}
+
+	if (victim < 0) return -1;
+
+	TRACE_SCOPE(prefetch ? "Tile prefetch" : "Tile upload");
+	const void* pixels = GetTilePixels(level, tile_x, tile_y);
+	if (pixels == NULL) return -1;
+
+	TileSlot& s = slots[victim];
+	if (s.tile >= 0) tile_slot[s.tile] = -1;
+
+	// Compressed payloads cannot be patched in place, the slot texture is recreated
+	if (s.texture.id == 0 || pixel_format >= PIXELFORMAT_COMPRESSED_DXT1_RGB)
+	{
+		if (s.texture.id != 0) UnloadTexture(s.texture);
+		Image img = { (void*)pixels, tile_size, tile_size, 1, pixel_format };
+		s.texture = LoadTextureFromImage(img);
+
+		// Coarse levels are drawn minified
+		SetTextureFilter(s.texture, TEXTURE_FILTER_BILINEAR);
+		SetTextureWrap(s.texture, TEXTURE_WRAP_CLAMP);
+	}
+	else
+	{
+		UpdateTexture(s.texture, pixels);
+	}
+
+	s.tile = tile;
+	s.last_used = prefetch ? frame - 1 : frame;
+	tile_slot[tile] = victim;
+
+	if (prefetch) prefetched++;
+
+	return victim;
+}
+
+const void* TileMap::GetTilePixels(int level, int tile_x, int tile_y)
+{
+	if (pack.IsOpen()) return pack.GetTile(level, tile_x, tile_y);
+
+	FillTile(levels[level], tile_x, tile_y);
+	return scratch.data();
+}
+
+void TileMap::FillTile(const Level& level, int tile_x, int tile_y)
+{
+	int x0 = tile_x * tile_size;
+	int y0 = tile_y * tile_size;
+	int w = MIN(tile_size, level.width - x0);
+	int h = MIN(tile_size, level.height - y0);
+
+	const uchar* pixels = (const uchar*)level.image.data;
+	size_t dst_pitch = (size_t)tile_size * bytes_per_pixel;
+	size_t src_pitch = (size_t)level.width * bytes_per_pixel;
+
+	for (int row = 0; row < h; ++row)
+	{
+		memcpy(&scratch[row * dst_pitch], pixels + (y0 + row) * src_pitch + (size_t)x0 * bytes_per_pixel, (size_t)w * bytes_per_pixel);
+	}
+
+	// Edge tiles: bilinear filtering at the last valid column / row blends in the texel
+	// past it, which would be whatever tile used the scratch buffer before. The last
+	// column and row are repeated over the padding, like a clamp at the map edge
+	if (w < tile_size)
+	{
+		for (int row = 0; row < h; ++row)
+		{
+			uchar* line = &scratch[row * dst_pitch];
+			const uchar* last = line + (size_t)(w - 1) * bytes_per_pixel;
+			for (int x = w; x < tile_size; ++x)
+				memcpy(line + (size_t)x * bytes_per_pixel, last, bytes_per_pixel);
+		}
+	}
+
+	for (int row = h; row < tile_size; ++row)
+	{
+		memcpy(&scratch[row * dst_pitch], &scratch[(h - 1) * dst_pitch], dst_pitch);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Globals.h"
+#include "TilePack.h"
+
+#include <vector>
+
+#define MAP_TILE_SIZE 512
+#define MAP_MAX_RESIDENT_TILES 48
+#define MAP_PREFETCH_PER_FRAME 2
+
+// Big track map split in fixed size tiles. Only the tiles around the camera are
+// uploaded, recycling the least recently used. Pixels come either from a baked
+// tile pack (mapped file, no decode) or from an image decoded at load time.
+// The map is kept as a pyramid of levels, each half the size of the previous one,
+// and Draw() picks the level that matches the requested scale
+class TileMap
+{
+public:
+	TileMap();
+	~TileMap();
+
+	bool Load(const char* path, int tile_size = MAP_TILE_SIZE, int max_resident = MAP_MAX_RESIDENT_TILES);
+	bool LoadPack(const char* path, int max_resident = MAP_MAX_RESIDENT_TILES);
+	void Unload();
+
+	// Call once per frame before any Draw(), tiles drawn since then are never evicted
+	void BeginFrame();
+
+	// Draw the part of the map that falls inside viewport (screen rectangle).
+	// camera is the screen position of the map origin and scale the world to screen factor
+	void Draw(float camera_x, float camera_y, float scale = 1.0f);
+	void Draw(Rectangle viewport, float camera_x, float camera_y, float scale);
+
+	bool IsLoaded() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetLevelCount() const;
+	int GetResidentTiles() const;
+
+private:
+	struct Level
+	{
+		int width = 0;
+		int height = 0;
+		int tiles_x = 0;
+		int tiles_y = 0;
+		int first_tile = 0;
+		float scale_x = 1.0f;   // map pixels per level pixel
+		float scale_y = 1.0f;
+		Image image = {};      // decoded image path only
+	};
+
+	struct TileSlot
+	{
+		Texture2D texture = {};
+		int tile = -1;
+		uint64 last_used = 0;
+	};
+
+	void AddLevel(int level_width, int level_height);
+	int SelectLevel(float scale) const;
+	int Acquire(int level, int tile_x, int tile_y, bool prefetch);
+	const void* GetTilePixels(int level, int tile_x, int tile_y);
+	void FillTile(const Level& level, int tile_x, int tile_y);
+
+private:
+	TilePack pack;
+	std::vector<Level> levels;
+
+	int tile_size;
+	int pixel_format;
+	int bytes_per_pixel;
+
+	std::vector<int> tile_slot;     // tile index (all levels) -> slot, -1 if not resident
+	std::vector<TileSlot> slots;
+	std::vector<uchar> scratch;     // one tile worth of pixels, reused on every upload
+
+	uint64 frame;
+	int prefetched;
+};
@@ -0,0 +1,186 @@
+#include "TilePack.h"
+
+// No Globals.h / raylib.h here: windows.h collides with raylib names
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOGDI
+	#define NOUSER
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+TilePack::TilePack()
+{
+	data = NULL;
+	data_size = 0;
+	header = NULL;
+	entries = NULL;
+
+#ifdef _WIN32
+	file_handle = NULL;
+	mapping_handle = NULL;
+#else
+	file_descriptor = -1;
+#endif
+}
+
+TilePack::~TilePack()
+{
+	Close();
+}
+
+bool TilePack::Open(const char* path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	file_handle = file;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		Close();
+		return false;
+	}
+	mapping_handle = mapping;
+
+	data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	data_size = (size_t)file_size.QuadPart;
+#else
+	file_descriptor = open(path, O_RDONLY);
+	if (file_descriptor < 0) return false;
+
+	struct stat info;
+	if (fstat(file_descriptor, &info) != 0 || info.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if (view != MAP_FAILED)
+	{
+		data = (const unsigned char*)view;
+		data_size = (size_t)info.st_size;
+	}
+#endif
+
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	header = (const TilePackHeader*)data;
+	entries = (const TilePackEntry*)(data + sizeof(TilePackHeader));
+
+	if (!Validate())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void TilePack::Close()
+{
+#ifdef _WIN32
+	if (data != NULL) UnmapViewOfFile(data);
+	if (mapping_handle != NULL) CloseHandle((HANDLE)mapping_handle);
+	if (file_handle != NULL) CloseHandle((HANDLE)file_handle);
+	mapping_handle = NULL;
+	file_handle = NULL;
+#else
+	if (data != NULL) munmap((void*)data, data_size);
+	if (file_descriptor >= 0) close(file_descriptor);
+	file_descriptor = -1;
+#endif
+
+	data = NULL;
+	data_size = 0;
+	header = NULL;
+	entries = NULL;
+}
+
+bool TilePack::IsOpen() const
+{
+	return data != NULL;
+}
+
+const TilePackHeader& TilePack::GetHeader() const
+{
+	return *header;
+}
+
+uint32_t TilePack::GetTileBytes() const
+{
+	return (data != NULL && header->tile_count > 0) ? entries[0].size : 0;
+}
+
+const unsigned char* TilePack::GetTile(int level, int tile_x, int tile_y, uint32_t* size) const
+{
+	if (data == NULL || level < 0 || level >= (int)header->level_count) return NULL;
+
+	const TilePackLevel& info = header->levels[level];
+	if (tile_x < 0 || tile_y < 0 || tile_x >= (int)info.tiles_x || tile_y >= (int)info.tiles_y) return NULL;
+
+	const TilePackEntry& entry = entries[info.first_entry + (uint32_t)tile_y * info.tiles_x + (uint32_t)tile_x];
+	if (size != NULL) *size = entry.size;
+
+	return data + entry.offset;
+}
+
+bool TilePack::Validate() const
+{
+	if (data_size < sizeof(TilePackHeader)) return false;
+	if (header->magic != TILE_PACK_MAGIC || header->version != TILE_PACK_VERSION) return false;
+	if (header->tile_size == 0 || header->tile_size > TILE_PACK_MAX_TILE_SIZE) return false;
+	if (header->level_count == 0 || header->level_count > TILE_PACK_MAX_LEVELS) return false;
+
+	// The tile grid of every level is what its size gives, the way TileMap rebuilds it,
+	// and the levels follow each other in the entry table. 64 bit math, nothing wraps
+	uint64_t tile_size = header->tile_size;
+	uint64_t next_entry = 0;
+	for (uint32_t i = 0; i < header->level_count; ++i)
+	{
+		const TilePackLevel& info = header->levels[i];
+		if (info.width == 0 || info.height == 0 || info.width > INT32_MAX || info.height > INT32_MAX) return false;
+		if (info.tiles_x != (info.width + tile_size - 1) / tile_size) return false;
+		if (info.tiles_y != (info.height + tile_size - 1) / tile_size) return false;
+		if (info.first_entry != next_entry) return false;
+		next_entry += (uint64_t)info.tiles_x * info.tiles_y;
+	}
+	if (next_entry != header->tile_count) return false;
+
+	uint64_t index_end = sizeof(TilePackHeader) + (uint64_t)header->tile_count * sizeof(TilePackEntry);
+	if (index_end > data_size) return false;
+
+	// A truncated pack would fault on first access instead of failing here.
+	// Every payload is a full tile, same size for all
+	uint32_t tile_bytes = entries[0].size;
+	if (tile_bytes == 0) return false;
+
+	for (uint32_t i = 0; i < header->tile_count; ++i)
+	{
+		const TilePackEntry& entry = entries[i];
+		if (entry.size != tile_bytes) return false;
+		if (entry.offset < index_end || entry.offset > data_size || entry.size > data_size - entry.offset) return false;
+	}
+
+	return true;
+}
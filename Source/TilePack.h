@@ -0,0 +1,84 @@
+#pragma once
+
+// Tile pack: the track map already decoded and cut in tiles by Tools/TilePackBaker.
+// Layout on disk: TilePackHeader, one TilePackEntry per tile (level by level, row major), payloads.
+// Level 0 is the full map, every next level halves the previous one until it fits in one tile.
+// Every payload is a full tile_size x tile_size block in pixel_format, edge tiles padded
+// with their last column and row repeated.
+//
+// This header is shared with the baker and stays free of raylib so TilePack.cpp can
+// include the OS headers needed to map the file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TILE_PACK_MAGIC 0x4B415054 // "TPAK"
+#define TILE_PACK_VERSION 2
+#define TILE_PACK_ALIGNMENT 4096
+#define TILE_PACK_MAX_LEVELS 16
+#define TILE_PACK_MAX_TILE_SIZE 2048    // a full tile of any raylib format stays below 2 GB
+
+struct TilePackLevel
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t tiles_x;
+	uint32_t tiles_y;
+	uint32_t first_entry;     // index of the level's first tile in the entry table
+	uint32_t reserved;
+};
+
+struct TilePackHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t tile_size;
+	uint32_t pixel_format;    // raylib PixelFormat of every payload
+	uint32_t level_count;
+	uint32_t tile_count;      // all levels
+	TilePackLevel levels[TILE_PACK_MAX_LEVELS];
+};
+
+struct TilePackEntry
+{
+	uint64_t offset;          // from the start of the file
+	uint32_t size;            // payload bytes
+	uint32_t reserved;
+};
+
+// Read only memory mapped view of a tile pack
+class TilePack
+{
+public:
+	TilePack();
+	~TilePack();
+
+	bool Open(const char* path);
+	void Close();
+
+	bool IsOpen() const;
+	const TilePackHeader& GetHeader() const;
+
+	// Bytes of every payload, Open() rejects packs whose tiles differ.
+	// Checking it against tile_size and pixel_format is up to the caller (needs raylib)
+	uint32_t GetTileBytes() const;
+
+	// Pointer straight into the mapped file, no copy and no decode. NULL if out of range
+	const unsigned char* GetTile(int level, int tile_x, int tile_y, uint32_t* size = NULL) const;
+
+private:
+	bool Validate() const;
+
+private:
+	const unsigned char* data;
+	size_t data_size;
+	const TilePackHeader* header;
+	const TilePackEntry* entries;
+
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int file_descriptor;
+#endif
+};
@@ -0,0 +1,167 @@
+#include "Trace.h"
+#include "Globals.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+bool trace_enabled = false;
+
+struct TraceEvent
+{
+	const char* name;
+	const char* arg;
+	double ts;                  // microseconds from TraceStart()
+	double value;
+	char phase;
+};
+
+// One per thread that emitted while tracing, appended to with no lock. Freed by TraceStop()
+struct TraceThread
+{
+	int tid = 0;
+	const char* name = nullptr;
+	std::vector<TraceEvent> events;
+	size_t dropped = 0;
+};
+
+static std::mutex threads_mutex;
+static std::vector<TraceThread*> threads;
+static thread_local TraceThread* this_thread = nullptr;
+static thread_local int this_generation = 0;
+static std::atomic<int> generation{ 1 };    // bumped by TraceStop(), older this_thread pointers are stale
+
+static std::chrono::steady_clock::time_point start_time;
+static const char* output_path = nullptr;
+
+static TraceThread* GetThread()
+{
+	if (this_thread == nullptr || this_generation != generation.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		this_generation = generation.load(std::memory_order_relaxed);
+		this_thread = new TraceThread();
+		this_thread->tid = (int)threads.size() + 1;
+		this_thread->events.reserve(4096);
+		threads.push_back(this_thread);
+	}
+	return this_thread;
+}
+
+void TraceEmit(char phase, const char* name, const char* arg, double value)
+{
+	TraceThread* thread = GetThread();
+	if (thread->events.size() >= TRACE_MAX_EVENTS_PER_THREAD)
+	{
+		thread->dropped++;
+		return;
+	}
+
+	TraceEvent e;
+	e.name = name;
+	e.arg = arg;
+	e.ts = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+	e.value = value;
+	e.phase = phase;
+	thread->events.push_back(e);
+}
+
+bool TraceStart(const char* path)
+{
+	if (trace_enabled) return false;
+
+	output_path = path;
+	start_time = std::chrono::steady_clock::now();
+	trace_enabled = true;
+
+	TraceThreadName("Main");
+	return true;
+}
+
+// Threads started while not tracing stay unnamed, and allocate nothing
+void TraceThreadName(const char* name)
+{
+	if (!trace_enabled) return;
+	GetThread()->name = name;
+}
+
+static void WriteString(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* c = text; *c != '\0'; ++c)
+	{
+		if (*c == '"' || *c == '\\') fputc('\\', file);
+		if ((unsigned char)*c >= 0x20) fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+void TraceStop()
+{
+	if (!trace_enabled) return;
+	trace_enabled = false;
+
+	FILE* file = fopen(output_path, "w");
+	if (file == NULL) LOG("Cannot write trace: %s", output_path);
+
+	std::lock_guard<std::mutex> lock(threads_mutex);
+
+	if (file != NULL)
+	{
+		fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		bool first = true;
+
+		for (const TraceThread* thread : threads)
+		{
+			if (thread->name != nullptr)
+			{
+				fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", thread->tid);
+				WriteString(file, thread->name);
+				fprintf(file, "}}");
+				first = false;
+			}
+
+			for (const TraceEvent& e : thread->events)
+			{
+				fprintf(file, "%s{\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", first ? "" : ",\n", e.phase, thread->tid, e.ts);
+				first = false;
+
+				if (e.name != nullptr)
+				{
+					fprintf(file, ",\"name\":");
+					WriteString(file, e.name);
+				}
+
+				if (e.phase == 'C')
+				{
+					fprintf(file, ",\"args\":{\"value\":%g}", e.value);
+				}
+				else if (e.arg != nullptr)
+				{
+					fprintf(file, ",\"args\":{\"arg\":");
+					WriteString(file, e.arg);
+					fprintf(file, "}");
+				}
+
+				// Instants only mark their own thread
+				if (e.phase == 'i') fprintf(file, ",\"s\":\"t\"");
+
+				fprintf(file, "}");
+			}
+
+			if (thread->dropped > 0)
+				LOG("Trace: thread %d dropped %llu events", thread->tid, (unsigned long long)thread->dropped);
+		}
+
+		fprintf(file, "\n]}\n");
+		fclose(file);
+	}
+
+	// Threads still alive see the new generation and start a new buffer if tracing starts again
+	for (TraceThread* thread : threads)
+		delete thread;
+	threads.clear();
+	generation++;
+}
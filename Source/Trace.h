@@ -0,0 +1,68 @@
+#pragma once
+
+// Event trace for offline analysis: begin / end spans, instants and counters from
+// any thread, written on TraceStop() as Chrome trace JSON (chrome://tracing, Perfetto).
+// Every call checks one flag first, so instrumentation left in costs a predictable
+// branch while tracing is off. Names and args are stored as pointers: pass string
+// literals or strings that outlive the trace
+
+#define TRACE_MAX_EVENTS_PER_THREAD (1 << 21)   // then the thread drops its events
+
+extern bool trace_enabled;
+
+void TraceEmit(char phase, const char* name, const char* arg, double value);
+
+// Start recording, the file is written by TraceStop(). Call with no job running
+bool TraceStart(const char* path);
+// Writes the file and frees every thread's buffer. Call once the other threads stopped tracing
+void TraceStop();
+
+// Label for the calling thread in the viewer, nothing while not tracing
+void TraceThreadName(const char* name);
+
+inline bool TraceIsEnabled()
+{
+	return trace_enabled;
+}
+
+inline void TraceBegin(const char* name, const char* arg = nullptr)
+{
+	if (trace_enabled) TraceEmit('B', name, arg, 0.0);
+}
+
+inline void TraceEnd()
+{
+	if (trace_enabled) TraceEmit('E', nullptr, nullptr, 0.0);
+}
+
+inline void TraceInstant(const char* name, const char* arg = nullptr)
+{
+	if (trace_enabled) TraceEmit('i', name, arg, 0.0);
+}
+
+inline void TraceCounter(const char* name, double value)
+{
+	if (trace_enabled) TraceEmit('C', name, nullptr, value);
+}
+
+// Span over the enclosing block. A span begun while tracing was off has no end either
+class TraceScope
+{
+public:
+	TraceScope(const char* name, const char* arg = nullptr) : active(trace_enabled)
+	{
+		if (active) TraceEmit('B', name, arg, 0.0);
+	}
+
+	~TraceScope()
+	{
+		if (active) TraceEmit('E', nullptr, nullptr, 0.0);
+	}
+
+private:
+	bool active;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
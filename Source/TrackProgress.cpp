@@ -0,0 +1,107 @@
+#include "TrackProgress.h"
+
+#include <math.h>
+
+TrackProgress::TrackProgress()
+{
+	lap_length = 0.0f;
+}
+
+TrackProgress::~TrackProgress()
+{
+}
+
+void TrackProgress::Clear()
+{
+	checkpoints.clear();
+	lap_length = 0.0f;
+}
+
+void TrackProgress::AddCheckpoint(int x, int y, int width, int height)
+{
+	TrackCheckpoint cp;
+	cp.x = (float)x;
+	cp.y = (float)y;
+	cp.width = (float)width;
+	cp.height = (float)height;
+	cp.start_distance = 0.0f;
+
+	if (!checkpoints.empty())
+	{
+		const TrackCheckpoint& prev = checkpoints.back();
+		cp.start_distance = prev.start_distance + hypotf(cp.x - prev.x, cp.y - prev.y);
+	}
+
+	checkpoints.push_back(cp);
+
+	// The line closes back on the first checkpoint
+	const TrackCheckpoint& first = checkpoints.front();
+	lap_length = cp.start_distance + hypotf(first.x - cp.x, first.y - cp.y);
+}
+
+int TrackProgress::GetCheckpointCount() const
+{
+	return (int)checkpoints.size();
+}
+
+const TrackCheckpoint& TrackProgress::GetCheckpoint(int index) const
+{
+	return checkpoints[index];
+}
+
+float TrackProgress::GetLapLength() const
+{
+	return lap_length;
+}
+
+bool TrackProgress::Update(TrackPosition& position, float x, float y, float angle, float car_width, float car_height) const
+{
+	int count = (int)checkpoints.size();
+	if (count == 0) return false;
+
+	if (position.next_checkpoint < 0 || position.next_checkpoint >= count)
+		position.next_checkpoint = 0;
+
+	// Axis aligned box around the rotated car, same reach the physics body had against the old sensors
+	float c = fabsf(cosf(angle));
+	float s = fabsf(sinf(angle));
+	float half_w = (car_width * c + car_height * s) * 0.5f;
+	float half_h = (car_width * s + car_height * c) * 0.5f;
+
+	bool lap_completed = false;
+
+	const TrackCheckpoint& next = checkpoints[position.next_checkpoint];
+	if (fabsf(x - next.x) <= half_w + next.width * 0.5f && fabsf(y - next.y) <= half_h + next.height * 0.5f)
+	{
+		position.next_checkpoint++;
+		if (position.next_checkpoint >= count)
+		{
+			position.next_checkpoint = 0;
+			position.lap++;
+			lap_completed = true;
+		}
+	}
+
+	// Distance at the next checkpoint minus what is left of the segment leading to it
+	const TrackCheckpoint& target = checkpoints[position.next_checkpoint];
+	const TrackCheckpoint& prev = checkpoints[(position.next_checkpoint + count - 1) % count];
+
+	float segment = SegmentLength(position.next_checkpoint);
+	float travelled = 0.0f;
+	if (segment > 0.0f)
+	{
+		travelled = ((x - prev.x) * (target.x - prev.x) + (y - prev.y) * (target.y - prev.y)) / segment;
+		if (travelled < 0.0f) travelled = 0.0f;
+		if (travelled > segment) travelled = segment;
+	}
+
+	position.distance = position.lap * lap_length + target.start_distance - (segment - travelled);
+
+	return lap_completed;
+}
+
+float TrackProgress::SegmentLength(int to) const
+{
+	if (to == 0) return lap_length - checkpoints.back().start_distance;
+	return checkpoints[to].start_distance - checkpoints[to - 1].start_distance;
+}
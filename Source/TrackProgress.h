@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+// Where a car is along the track
+struct TrackPosition
+{
+	int next_checkpoint = 0;
+	int lap = 0;
+	float distance = 0.0f;      // pixels driven along the checkpoint line since the start, laps included
+};
+
+struct TrackCheckpoint
+{
+	float x, y;                 // center, map pixels
+	float width, height;
+	float start_distance;       // along the checkpoint line from checkpoint 0
+};
+
+// Ordered list of checkpoint rectangles. Every car only has to touch its next
+// checkpoint, so a query is one overlap test and one projection whatever the
+// number of checkpoints or cars. Checkpoints are plain data, not physics bodies
+class TrackProgress
+{
+public:
+	TrackProgress();
+	~TrackProgress();
+
+	void Clear();
+	void AddCheckpoint(int x, int y, int width, int height);
+
+	int GetCheckpointCount() const;
+	const TrackCheckpoint& GetCheckpoint(int index) const;
+	float GetLapLength() const;
+
+	// Advance position for a car box (map pixels, angle in radians) and refresh its distance.
+	// Returns true when the car just completed a lap
+	bool Update(TrackPosition& position, float x, float y, float angle, float car_width, float car_height) const;
+
+private:
+	float SegmentLength(int to) const;
+
+private:
+	std::vector<TrackCheckpoint> checkpoints;
+	float lap_length;
+};
@@ -0,0 +1,103 @@
+#include "VoiceManager.h"
+
+#include <algorithm>
+
+void VoiceManager::Init(int voice_count, float min_volume)
+{
+	owners.assign(voice_count, -1);
+	candidates.clear();
+	selected.clear();
+	this->min_volume = min_volume;
+	real_count = 0;
+	virtual_count = 0;
+}
+
+void VoiceManager::Assign(std::vector<VoiceEmitter>& emitters)
+{
+	const int count = (int)emitters.size();
+
+	// Emitters gone since the last call (owner shrank the list) lose their voice
+	for (int& owner : owners)
+	{
+		if (owner >= count) owner = -1;
+	}
+
+	// Audible emitters that already play or may start
+	candidates.clear();
+	int audible = 0;
+	for (int e = 0; e < count; ++e)
+	{
+		const VoiceEmitter& emitter = emitters[e];
+		if (emitter.volume < min_volume) continue;
+		audible++;
+		if (emitter.voice == VOICE_VIRTUAL && !emitter.can_start) continue;
+		candidates.push_back(e);
+	}
+
+	// Highest priority first, then the loudest. Only the first voices matter,
+	// the rest stay unsorted
+	int voice_count = (int)owners.size();
+	int keep = std::min(voice_count, (int)candidates.size());
+	auto better = [&emitters](int a, int b)
+	{
+		if (emitters[a].priority != emitters[b].priority) return emitters[a].priority > emitters[b].priority;
+		if (emitters[a].volume != emitters[b].volume) return emitters[a].volume > emitters[b].volume;
+		return a < b;
+	};
+	if (keep < (int)candidates.size())
+		std::nth_element(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+
+	selected.assign(count, 0);
+	for (int c = 0; c < keep; ++c) selected[candidates[c]] = 1;
+
+	// Voices of emitters no longer selected are freed, the rest keep theirs
+	for (int v = 0; v < voice_count; ++v)
+	{
+		int owner = owners[v];
+		if (owner >= 0 && (!selected[owner] || emitters[owner].voice != v)) owners[v] = -1;
+	}
+
+	for (int e = 0; e < count; ++e)
+	{
+		VoiceEmitter& emitter = emitters[e];
+		emitter.fresh = false;
+		if (!selected[e]) emitter.voice = VOICE_VIRTUAL;
+		else if (emitter.voice != VOICE_VIRTUAL && owners[emitter.voice] != e) emitter.voice = VOICE_VIRTUAL;
+	}
+
+	// Newly selected emitters take the free voices
+	int next_free = 0;
+	for (int c = 0; c < keep; ++c)
+	{
+		VoiceEmitter& emitter = emitters[candidates[c]];
+		if (emitter.voice != VOICE_VIRTUAL) continue;
+
+		while (owners[next_free] >= 0) next_free++;
+		owners[next_free] = candidates[c];
+		emitter.voice = next_free;
+		emitter.fresh = true;
+	}
+
+	real_count = keep;
+	virtual_count = audible - keep;
+}
+
+int VoiceManager::GetVoiceCount() const
+{
+	return (int)owners.size();
+}
+
+int VoiceManager::GetOwner(int voice) const
+{
+	return owners[voice];
+}
+
+int VoiceManager::GetRealCount() const
+{
+	return real_count;
+}
+
+int VoiceManager::GetVirtualCount() const
+{
+	return virtual_count;
+}
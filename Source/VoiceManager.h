@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Globals.h"
+
+#include <vector>
+
+#define VOICE_VIRTUAL -1
+
+// A sound that wants to be heard. The caller owns the emitters and fills in
+// priority, volume and pan, Assign() decides which ones get a voice
+struct VoiceEmitter
+{
+	int priority = 0;           // higher wins, then the louder one
+	float volume = 0.0f;        // after distance attenuation, 0 for emitters not playing
+	float pan = 0.0f;           // -1 left .. 1 right
+	bool can_start = true;      // may take a voice now (one-shots only on the frame they start)
+	int voice = VOICE_VIRTUAL;  // voice mixing it, or tracked but not mixed
+	bool fresh = false;         // took its voice on the last Assign()
+};
+
+// Fixed pool of voices shared by any number of emitters, so the mixing cost is
+// bounded whatever the number of cars or FX playing. The audible emitters with
+// the highest priority get the voices, the rest are virtual: still tracked by
+// their owner, not mixed. An emitter keeps its voice while it stays selected,
+// voices only change hands when the selection does
+class VoiceManager
+{
+public:
+	void Init(int voice_count, float min_volume);
+
+	// Selects the emitters mixed this frame and updates voice / fresh of every emitter
+	void Assign(std::vector<VoiceEmitter>& emitters);
+
+	int GetVoiceCount() const;
+
+	// Emitter mixed by voice, -1 free
+	int GetOwner(int voice) const;
+
+	// Result of the last Assign(): voices in use and audible emitters left virtual
+	int GetRealCount() const;
+	int GetVirtualCount() const;
+
+private:
+	std::vector<int> owners;
+	std::vector<int> candidates;    // scratch, emitters that may be mixed
+	std::vector<uchar> selected;    // scratch, per emitter
+	float min_volume = 0.0f;
+	int real_count = 0;
+	int virtual_count = 0;
+};
@@ -0,0 +1,87 @@
+// raylib core for the headless simulation: no window, no graphics device, no input.
+// rcore.c built with no PLATFORM_* defined expects a custom platform backend defined
+// next to it (see platforms/rcore_template.c), this is that backend. The headless
+// game never calls InitWindow(), so every entry point is a no-op that reports no
+// window: images, fonts data, files and the rest of raylib keep working as usual.
+// Built by CMake for the headless targets only, instead of rcore.c and rglfw.c
+
+#include "rcore.c"
+
+#include <time.h>
+
+//----------------------------------------------------------------------------------
+// Window and Graphics Device
+//----------------------------------------------------------------------------------
+bool WindowShouldClose(void) { return true; }
+void ToggleFullscreen(void) { }
+void ToggleBorderlessWindowed(void) { }
+void MaximizeWindow(void) { }
+void MinimizeWindow(void) { }
+void RestoreWindow(void) { }
+void SetWindowState(unsigned int flags) { (void)flags; }
+void ClearWindowState(unsigned int flags) { (void)flags; }
+void SetWindowIcon(Image image) { (void)image; }
+void SetWindowIcons(Image *images, int count) { (void)images; (void)count; }
+void SetWindowTitle(const char *title) { CORE.Window.title = title; }
+void SetWindowPosition(int x, int y) { (void)x; (void)y; }
+void SetWindowMonitor(int monitor) { (void)monitor; }
+void SetWindowMinSize(int width, int height) { (void)width; (void)height; }
+void SetWindowMaxSize(int width, int height) { (void)width; (void)height; }
+void SetWindowSize(int width, int height) { (void)width; (void)height; }
+void SetWindowOpacity(float opacity) { (void)opacity; }
+void SetWindowFocused(void) { }
+void *GetWindowHandle(void) { return NULL; }
+int GetMonitorCount(void) { return 0; }
+int GetCurrentMonitor(void) { return 0; }
+Vector2 GetMonitorPosition(int monitor) { (void)monitor; return (Vector2){ 0.0f, 0.0f }; }
+int GetMonitorWidth(int monitor) { (void)monitor; return 0; }
+int GetMonitorHeight(int monitor) { (void)monitor; return 0; }
+int GetMonitorPhysicalWidth(int monitor) { (void)monitor; return 0; }
+int GetMonitorPhysicalHeight(int monitor) { (void)monitor; return 0; }
+int GetMonitorRefreshRate(int monitor) { (void)monitor; return 0; }
+const char *GetMonitorName(int monitor) { (void)monitor; return ""; }
+Vector2 GetWindowPosition(void) { return (Vector2){ 0.0f, 0.0f }; }
+Vector2 GetWindowScaleDPI(void) { return (Vector2){ 1.0f, 1.0f }; }
+void SetClipboardText(const char *text) { (void)text; }
+const char *GetClipboardText(void) { return NULL; }
+void ShowCursor(void) { }
+void HideCursor(void) { }
+void EnableCursor(void) { }
+void DisableCursor(void) { }
+void SwapScreenBuffer(void) { }
+
+//----------------------------------------------------------------------------------
+// Misc
+//----------------------------------------------------------------------------------
+
+// Seconds since the first call, the game only uses differences
+double GetTime(void)
+{
+    struct timespec ts = { 0 };
+    timespec_get(&ts, TIME_UTC);
+    unsigned long long int nanoSeconds = (unsigned long long int)ts.tv_sec*1000000000LLU + (unsigned long long int)ts.tv_nsec;
+
+    if (CORE.Time.base == 0) CORE.Time.base = nanoSeconds;
+    return (double)(nanoSeconds - CORE.Time.base)*1e-9;
+}
+
+void OpenURL(const char *url) { (void)url; }
+
+//----------------------------------------------------------------------------------
+// Inputs: nothing is ever pressed
+//----------------------------------------------------------------------------------
+int SetGamepadMappings(const char *mappings) { (void)mappings; return 0; }
+void SetMousePosition(int x, int y) { (void)x; (void)y; }
+void SetMouseCursor(int cursor) { (void)cursor; }
+void PollInputEvents(void) { }
+
+//----------------------------------------------------------------------------------
+// Platform
+//----------------------------------------------------------------------------------
+int InitPlatform(void)
+{
+    TRACELOG(LOG_WARNING, "PLATFORM: HEADLESS: raylib built without a window backend, run with --headless");
+    return -1;
+}
+
+void ClosePlatform(void) { }
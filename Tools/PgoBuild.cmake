@@ -0,0 +1,232 @@
+# ----------------------------------------------------
+# PgoBuild.cmake
+# Profile guided + LTO release build with a reproducible training run,
+# and how much it gains over the plain Release build:
+#   1. release preset, the baseline
+#   2. pgo-generate preset: instrumented build
+#   3. training: a seeded headless AI race (or a recorded replay) and
+#      RaceBench on 10 and 100 car fields, same input every time
+#   4. pgo-use preset: game, box2d and raylib rebuilt with the profiles and LTO
+#   5. both builds race the measurement seed and run RaceBench, the
+#      report compares ticks per second and the per tick stage times
+# Both builds have to finish the measured race with the same standings,
+# the optimisations must not change the simulation
+#
+# usage: cmake [-DTRAIN_SEED=N] [-DTRAIN_REPLAY=FILE] [-DMEASURE_SEED=N] [-DRUNS=N] -P Tools/PgoBuild.cmake
+# Run from the repository root. Report in build/pgo/pgo-report.md
+# ----------------------------------------------------
+
+cmake_minimum_required(VERSION 3.21)
+
+if(NOT DEFINED TRAIN_SEED)
+	set(TRAIN_SEED 1)
+endif()
+if(NOT DEFINED MEASURE_SEED)
+	set(MEASURE_SEED 42)
+endif()
+# Best of RUNS for every measurement, the machine is never completely idle
+if(NOT DEFINED RUNS)
+	set(RUNS 3)
+endif()
+
+get_filename_component(ROOT "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+set(RELEASE_DIR ${ROOT}/build/release)
+set(PGO_DIR ${ROOT}/build/pgo)
+set(BENCH_CARS 10,100,1000)
+
+function(run)
+	execute_process(COMMAND ${ARGN} WORKING_DIRECTORY ${ROOT} RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		string(REPLACE ";" " " command "${ARGN}")
+		message(FATAL_ERROR "PgoBuild: failed (${result}): ${command}")
+	endif()
+endfunction()
+
+# Single config generators put the binaries in bin/, multi config ones in bin/Release/
+function(find_binary out build_dir name)
+	foreach(candidate ${build_dir}/bin/${name} ${build_dir}/bin/${name}.exe ${build_dir}/bin/Release/${name} ${build_dir}/bin/Release/${name}.exe)
+		if(EXISTS ${candidate})
+			set(${out} ${candidate} PARENT_SCOPE)
+			return()
+		endif()
+	endforeach()
+	message(FATAL_ERROR "PgoBuild: ${name} not found in ${build_dir}/bin")
+endfunction()
+
+function(build preset)
+	message(STATUS "PgoBuild: building ${preset}")
+	run(${CMAKE_COMMAND} --preset ${preset})
+	run(${CMAKE_COMMAND} --build --preset ${preset} --config Release)
+endfunction()
+
+# Headless race: best ticks/s of RUNS and its standings (every line but the timing one)
+function(measure_race out_tps out_standings build_dir)
+	find_binary(game ${build_dir} PhysicsGameHeadless)
+	set(best 0)
+	foreach(i RANGE 1 ${RUNS})
+		execute_process(COMMAND ${game} --seed ${MEASURE_SEED} WORKING_DIRECTORY ${ROOT} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+		if(NOT result EQUAL 0)
+			message(FATAL_ERROR "PgoBuild: race failed in ${build_dir}")
+		endif()
+		string(REGEX MATCH "([0-9]+) ticks/s" timing "${output}")
+		if(CMAKE_MATCH_1 GREATER best)
+			set(best ${CMAKE_MATCH_1})
+		endif()
+		string(REGEX REPLACE "Simulated [^\n]*\n" "" standings "${output}")
+	endforeach()
+	set(${out_tps} ${best} PARENT_SCOPE)
+	set(${out_standings} "${standings}" PARENT_SCOPE)
+endfunction()
+
+# "12.5" microseconds to 12500 nanoseconds, math() is integer only
+function(us_to_ns out us)
+	if(us MATCHES "^([0-9]+)\\.([0-9]*)$")
+		set(whole ${CMAKE_MATCH_1})
+		string(SUBSTRING "${CMAKE_MATCH_2}000" 0 3 frac)
+	elseif(us MATCHES "^([0-9]+)$")
+		set(whole ${CMAKE_MATCH_1})
+		set(frac 000)
+	else()
+		message(FATAL_ERROR "PgoBuild: unexpected time in the RaceBench results: ${us}")
+	endif()
+	math(EXPR ns "${whole} * 1000 + ${frac}")
+	set(${out} ${ns} PARENT_SCOPE)
+endfunction()
+
+# RaceBench, lowest mean of RUNS per field size and stage: <prefix>_<cars>_<bench> in microseconds
+function(measure_bench prefix build_dir)
+	find_binary(bench ${build_dir} RaceBench)
+	foreach(i RANGE 1 ${RUNS})
+		run(${bench} --cars ${BENCH_CARS} --seed ${MEASURE_SEED} --out ${build_dir}/race_bench.json)
+		file(READ ${build_dir}/race_bench.json json)
+		string(JSON run_count LENGTH "${json}" runs)
+		math(EXPR last "${run_count} - 1")
+		foreach(r RANGE ${last})
+			string(JSON cars GET "${json}" runs ${r} cars)
+			string(JSON tps GET "${json}" runs ${r} ticks_per_second)
+			string(REGEX REPLACE "\\..*$" "" tps "${tps}")
+			if(tps EQUAL 0)
+				set(tps 1)
+			endif()
+			# Whole tick as frame time
+			math(EXPR tick_ns "1000000000 / ${tps}")
+			set(values "tick=${tick_ns}")
+			foreach(b step ai movement checkpoints hud)
+				string(JSON mean GET "${json}" runs ${r} benches ${b} mean_us)
+				us_to_ns(mean_ns "${mean}")
+				list(APPEND values "${b}=${mean_ns}")
+			endforeach()
+			foreach(pair ${values})
+				string(REPLACE "=" ";" pair "${pair}")
+				list(GET pair 0 b)
+				list(GET pair 1 v)
+				set(key ${prefix}_${cars}_${b})
+				if(NOT DEFINED ${key} OR v LESS ${key})
+					set(${key} ${v})
+				endif()
+				set(${key} ${${key}} PARENT_SCOPE)
+			endforeach()
+			set(${prefix}_cars ${${prefix}_cars} ${cars})
+		endforeach()
+	endforeach()
+	list(REMOVE_DUPLICATES ${prefix}_cars)
+	set(${prefix}_cars ${${prefix}_cars} PARENT_SCOPE)
+endfunction()
+
+# "+12.3%" of after against before
+function(delta out before after)
+	if(before EQUAL 0)
+		set(${out} "n/a" PARENT_SCOPE)
+		return()
+	endif()
+	math(EXPR permille "(${after} - ${before}) * 1000 / ${before}")
+	set(sign "+")
+	if(permille LESS 0)
+		set(sign "-")
+		math(EXPR permille "-${permille}")
+	endif()
+	math(EXPR whole "${permille} / 10")
+	math(EXPR tenth "${permille} % 10")
+	set(${out} "${sign}${whole}.${tenth}%" PARENT_SCOPE)
+endfunction()
+
+function(format_us out ns)
+	math(EXPR whole "${ns} / 1000")
+	math(EXPR frac "${ns} % 1000")
+	string(LENGTH "${frac}" length)
+	while(length LESS 3)
+		set(frac "0${frac}")
+		string(LENGTH "${frac}" length)
+	endwhile()
+	set(${out} "${whole}.${frac}" PARENT_SCOPE)
+endfunction()
+
+# ---- 1. Baseline ----
+build(release)
+
+# ---- 2. Instrumented ----
+file(REMOVE_RECURSE ${PGO_DIR}/pgo-profiles)
+build(pgo-generate)
+
+# ---- 3. Training ----
+message(STATUS "PgoBuild: training")
+find_binary(train_game ${PGO_DIR} PhysicsGameHeadless)
+find_binary(train_bench ${PGO_DIR} RaceBench)
+if(DEFINED TRAIN_REPLAY)
+	run(${train_game} --replay ${TRAIN_REPLAY})
+else()
+	run(${train_game} --seed ${TRAIN_SEED})
+endif()
+run(${train_bench} --cars 10,100 --seed ${TRAIN_SEED} --out ${PGO_DIR}/train_bench.json)
+
+# Clang writes raw profiles, they are merged into the one -fprofile-use reads
+file(GLOB raw_profiles ${PGO_DIR}/pgo-profiles/*.profraw)
+if(raw_profiles)
+	find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+	run(${LLVM_PROFDATA} merge -output=${PGO_DIR}/pgo-profiles/default.profdata ${raw_profiles})
+endif()
+
+# ---- 4. Optimised with the profiles ----
+build(pgo-use)
+
+# ---- 5. Measure ----
+message(STATUS "PgoBuild: measuring, best of ${RUNS}")
+measure_race(release_tps release_standings ${RELEASE_DIR})
+measure_race(pgo_tps pgo_standings ${PGO_DIR})
+measure_bench(release ${RELEASE_DIR})
+measure_bench(pgo ${PGO_DIR})
+
+if(NOT release_standings STREQUAL pgo_standings)
+	message(FATAL_ERROR "PgoBuild: the PGO build finished the seed ${MEASURE_SEED} race differently from Release\n"
+		"Release:\n${release_standings}\nPGO:\n${pgo_standings}")
+endif()
+
+delta(race_delta ${release_tps} ${pgo_tps})
+set(report "# PGO + LTO against Release\n\n")
+string(APPEND report "Training: ")
+if(DEFINED TRAIN_REPLAY)
+	string(APPEND report "replay ${TRAIN_REPLAY}")
+else()
+	string(APPEND report "headless race seed ${TRAIN_SEED}")
+endif()
+string(APPEND report ", RaceBench 10 and 100 cars. Measured: race seed ${MEASURE_SEED}, best of ${RUNS}, same standings in both builds.\n\n")
+string(APPEND report "| Headless race | Release | PGO + LTO | Delta |\n|---|---:|---:|---:|\n")
+string(APPEND report "| Sim throughput (ticks/s) | ${release_tps} | ${pgo_tps} | ${race_delta} |\n\n")
+string(APPEND report "Mean per tick, microseconds (lower is better):\n\n")
+string(APPEND report "| Cars | Stage | Release | PGO + LTO | Delta |\n|---:|---|---:|---:|---:|\n")
+foreach(cars ${release_cars})
+	foreach(b tick step ai movement checkpoints hud)
+		format_us(before ${release_${cars}_${b}})
+		format_us(after ${pgo_${cars}_${b}})
+		delta(d ${release_${cars}_${b}} ${pgo_${cars}_${b}})
+		set(name ${b})
+		if(b STREQUAL "tick")
+			set(name "frame time (whole tick)")
+		endif()
+		string(APPEND report "| ${cars} | ${name} | ${before} | ${after} | ${d} |\n")
+	endforeach()
+endforeach()
+
+file(WRITE ${PGO_DIR}/pgo-report.md "${report}")
+message("${report}")
+message(STATUS "PgoBuild: report written to ${PGO_DIR}/pgo-report.md, optimised binaries in ${PGO_DIR}/bin")
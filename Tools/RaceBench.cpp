@@ -0,0 +1,291 @@
+// ----------------------------------------------------
+// RaceBench.cpp
+// Benchmark of the per tick hot paths of a whole headless race for
+// fields of different sizes: the Box2D step, the AI and movement
+// stages of the car pipeline, checkpoint progress (lap bookkeeping
+// and standings) and formatting the HUD text. Every sample is one
+// simulation tick, read back from the profiler scopes of that tick.
+// Every field runs once per worker count, the AI stage scaling is
+// reported against the first count of the list.
+// Results go to a JSON file, a summary table to stdout
+//
+// usage: RaceBench [--cars N,N,...] [--ticks N] [--warmup N] [--workers N,N,...] [--seed N] [--out FILE]
+// Run from the repository root, the race needs Assets/mapa_montmelo.racingline
+// ----------------------------------------------------
+
+#include "Application.h"
+#include "Globals.h"
+#include "ModuleGame.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+enum Bench
+{
+	BENCH_STEP,           // world->Step
+	BENCH_AI,             // AI steering and throttle, every AI car
+	BENCH_MOVEMENT,       // refuel and movement, every car
+	BENCH_CHECKPOINTS,    // checkpoint progress, laps and standings
+	BENCH_HUD,            // HUD text of the frame
+	BENCH_COUNT
+};
+
+// Profiler scope measured by each bench, the HUD is timed here
+static const char* bench_names[BENCH_COUNT] = { "step", "ai", "movement", "checkpoints", "hud" };
+static const char* bench_scopes[BENCH_COUNT] = { "Step", "AI", "Movement", "Checkpoints", NULL };
+
+struct BenchStats
+{
+	double mean_us = 0.0;
+	double p50_us = 0.0;
+	double p99_us = 0.0;
+	double max_us = 0.0;
+};
+
+struct RunResult
+{
+	int ai_cars = 0;
+	int workers = 0;
+	int ticks = 0;
+	double ticks_per_second = 0.0;
+	unsigned int checksum = 0;
+	BenchStats stats[BENCH_COUNT];
+};
+
+static void PrintUsage()
+{
+	printf("usage: RaceBench [--cars N,N,...] [--ticks N] [--warmup N] [--workers N,N,...] [--seed N] [--out FILE]\n");
+	printf("  --cars N,N,...  AI cars of every run, spread around the lap (default 10,100,1000)\n");
+	printf("  --ticks N       ticks measured per run (default 600)\n");
+	printf("  --warmup N      ticks run before measuring (default 60)\n");
+	printf("  --workers N,... job system threads besides the main one, every field runs with each\n");
+	printf("                  (default one per extra core)\n");
+	printf("  --seed N        race seed (default 1)\n");
+	printf("  --out FILE      JSON results (default race_bench.json)\n");
+}
+
+// "N,N,..." into values, false on anything else
+static bool ParseList(char* text, std::vector<int>& values)
+{
+	for (char* next = text; *next != '\0';)
+	{
+		values.push_back((int)strtol(next, &next, 10));
+		if (*next == ',') next++;
+		else if (*next != '\0') return false;
+	}
+	return true;
+}
+
+static BenchStats ComputeStats(std::vector<float>& samples)
+{
+	BenchStats stats;
+	if (samples.empty()) return stats;
+
+	std::sort(samples.begin(), samples.end());
+
+	double total = 0.0;
+	for (float s : samples) total += s;
+
+	int count = (int)samples.size();
+	stats.mean_us = total / count;
+	stats.p50_us = samples[count / 2];
+	stats.p99_us = samples[MIN(count - 1, count * 99 / 100)];
+	stats.max_us = samples.back();
+	return stats;
+}
+
+// Sum of every scope of the frame with that name (a stage may run more than once per tick)
+static float ScopeTime(const Profiler::Frame& frame, const char* name)
+{
+	float total = 0.0f;
+	for (int s = 0; s < frame.scope_count; ++s)
+	{
+		if (strcmp(frame.scopes[s].name, name) == 0) total += frame.scopes[s].duration_us;
+	}
+	return total;
+}
+
+static bool RunRace(int ai_cars, int ticks, int warmup, int workers, uint64 seed, RunResult& result)
+{
+	using Clock = std::chrono::steady_clock;
+
+	Application* app = new Application(true);
+	app->SetCarCount(ai_cars);
+	app->SetSeed(seed);
+	app->SetWorkerCount(workers);
+
+	if (!app->Init())
+	{
+		fprintf(stderr, "RaceBench: race with %d cars failed to start\n", ai_cars);
+		app->CleanUp();
+		delete app;
+		return false;
+	}
+
+	std::vector<float> samples[BENCH_COUNT];
+	for (int b = 0; b < BENCH_COUNT; ++b) samples[b].reserve(ticks);
+
+	HudText hud;
+
+	int measured = 0;
+	double measured_seconds = 0.0;
+	update_status status = UPDATE_CONTINUE;
+
+	for (int t = 0; t < warmup + ticks && status == UPDATE_CONTINUE; ++t)
+	{
+		Clock::time_point start = Clock::now();
+		status = app->Update();
+		double tick_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		if (status == UPDATE_ERROR || t < warmup) continue;
+
+		const Profiler::Frame& frame = app->profiler->GetFrame(app->profiler->GetFrameCount() - 1);
+		for (int b = 0; b < BENCH_COUNT; ++b)
+		{
+			if (bench_scopes[b] != NULL) samples[b].push_back(ScopeTime(frame, bench_scopes[b]));
+		}
+
+		start = Clock::now();
+		app->scene_intro->FormatHud(hud);
+		samples[BENCH_HUD].push_back(std::chrono::duration<float, std::micro>(Clock::now() - start).count());
+		// checksum keeps the compiler from dropping the HUD text
+		for (int l = 0; l < hud.count; ++l) result.checksum += (unsigned char)hud.lines[l][0];
+
+		measured++;
+		measured_seconds += tick_seconds;
+	}
+
+	if (measured < ticks)
+		fprintf(stderr, "RaceBench: race with %d cars stopped after %d measured ticks\n", ai_cars, measured);
+
+	result.ai_cars = ai_cars;
+	result.workers = app->jobs->GetThreadCount() - 1;
+	result.ticks = measured;
+	result.ticks_per_second = measured_seconds > 0.0 ? measured / measured_seconds : 0.0;
+	for (int b = 0; b < BENCH_COUNT; ++b)
+		result.stats[b] = ComputeStats(samples[b]);
+
+	app->CleanUp();
+	delete app;
+
+	return status != UPDATE_ERROR;
+}
+
+static bool WriteJSON(const char* path, const std::vector<RunResult>& results, int warmup, uint64 seed)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL) return false;
+
+	fprintf(file, "{\n  \"benchmark\": \"RaceBench\",\n  \"warmup_ticks\": %d,\n  \"seed\": %llu,\n  \"runs\": [\n",
+		warmup, (unsigned long long)seed);
+
+	for (size_t r = 0; r < results.size(); ++r)
+	{
+		const RunResult& run = results[r];
+		fprintf(file, "    {\n      \"ai_cars\": %d,\n      \"cars\": %d,\n      \"workers\": %d,\n      \"ticks\": %d,\n      \"ticks_per_second\": %.1f,\n      \"benches\": {\n",
+			run.ai_cars, run.ai_cars + 1, run.workers, run.ticks, run.ticks_per_second);
+
+		for (int b = 0; b < BENCH_COUNT; ++b)
+		{
+			const BenchStats& s = run.stats[b];
+			fprintf(file, "        \"%s\": { \"mean_us\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"mean_ns_per_car\": %.3f }%s\n",
+				bench_names[b], s.mean_us, s.p50_us, s.p99_us, s.max_us, s.mean_us * 1000.0 / (run.ai_cars + 1), b + 1 < BENCH_COUNT ? "," : "");
+		}
+
+		fprintf(file, "      }\n    }%s\n", r + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> car_counts;
+	std::vector<int> worker_counts;
+	int ticks = 600;
+	int warmup = 60;
+	uint64 seed = 1;
+	const char* out_path = "race_bench.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		bool ok = true;
+		if (strcmp(argv[i], "--cars") == 0 && i + 1 < argc) ok = ParseList(argv[++i], car_counts);
+		else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) ok = ParseList(argv[++i], worker_counts);
+		else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) ticks = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+		else ok = false;
+
+		if (!ok)
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (car_counts.empty()) car_counts = { 10, 100, 1000 };
+	if (worker_counts.empty()) worker_counts = { -1 };
+
+	bool valid = ticks > 0 && warmup >= 0;
+	for (int cars : car_counts) valid = valid && cars > 0;
+	for (int workers : worker_counts) valid = valid && workers >= -1;
+	if (!valid)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<RunResult> results;
+	for (int cars : car_counts)
+	{
+		for (int workers : worker_counts)
+		{
+			RunResult result;
+			if (!RunRace(cars, ticks, warmup, workers, seed, result)) return EXIT_FAILURE;
+			results.push_back(result);
+		}
+	}
+
+	if (!WriteJSON(out_path, results, warmup, seed))
+	{
+		fprintf(stderr, "RaceBench: cannot write %s\n", out_path);
+		return EXIT_FAILURE;
+	}
+
+	// The races print their standings on CleanUp, the summary goes last
+	printf("\n%8s %8s %-12s %10s %10s %10s %10s %12s\n", "cars", "workers", "bench", "mean us", "p50 us", "p99 us", "max us", "ns/car");
+	for (const RunResult& run : results)
+	{
+		for (int b = 0; b < BENCH_COUNT; ++b)
+		{
+			const BenchStats& s = run.stats[b];
+			printf("%8d %8d %-12s %10.2f %10.2f %10.2f %10.2f %12.1f\n", run.ai_cars + 1, run.workers, bench_names[b],
+				s.mean_us, s.p50_us, s.p99_us, s.max_us, s.mean_us * 1000.0 / (run.ai_cars + 1));
+		}
+		printf("%8d %8d %-12s %10.0f ticks/s over %d ticks (checksum %u)\n", run.ai_cars + 1, run.workers, "whole tick", run.ticks_per_second, run.ticks, run.checksum);
+	}
+
+	// AI stage speedup of every worker count over the first one, same field
+	if (worker_counts.size() > 1)
+	{
+		printf("\n%8s %8s %10s %10s\n", "cars", "workers", "ai us", "speedup");
+		for (size_t r = 0; r < results.size(); ++r)
+		{
+			const RunResult& base = results[r - r % worker_counts.size()];
+			double ai_us = results[r].stats[BENCH_AI].mean_us;
+			printf("%8d %8d %10.2f %9.2fx\n", results[r].ai_cars + 1, results[r].workers, ai_us,
+				ai_us > 0.0 ? base.stats[BENCH_AI].mean_us / ai_us : 0.0);
+		}
+	}
+	printf("Results written to %s\n", out_path);
+
+	return EXIT_SUCCESS;
+}
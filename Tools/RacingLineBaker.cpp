@@ -0,0 +1,330 @@
+// ----------------------------------------------------
+// RacingLineBaker.cpp
+// Offline tool: fits the racing line through the track checkpoints
+// (the cpData list exported from the game) and writes the lookup
+// table the AI drives from at runtime (see RacingLine.h)
+//
+// usage: RacingLineBaker <cpData.txt> <out.racingline> [options]
+// ----------------------------------------------------
+
+#include "RacingLine.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Same scale and car limits as the game (ModulePhysics.h, ModuleGame.cpp)
+#define PIXELS_PER_METER 50.0f
+#define CAR_MAX_SPEED 12.0f
+#define CAR_ACCELERATION 3.45f
+
+struct Point
+{
+	float x, y;
+};
+
+struct Checkpoint
+{
+	Point center;
+	float width, height;
+};
+
+static void PrintUsage()
+{
+	printf("usage: RacingLineBaker <cpData.txt> <out.racingline> [options]\n");
+	printf("  --spacing N        pixels between samples (default 16)\n");
+	printf("  --max-offset N     how far the line may leave the center line, pixels (default 60)\n");
+	printf("  --margin N         distance kept from the checkpoint edges, pixels (default 30)\n");
+	printf("  --lateral-accel A  cornering limit, m/s^2 (default 40)\n");
+	printf("  --braking A        deceleration used for brake points, m/s^2 (default 3.45)\n");
+}
+
+// Checkpoint centers from lines like "    {10779, 5460, 300, 120}, // 00"
+static bool ReadCheckpoints(const char* path, std::vector<Checkpoint>& checkpoints)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL) return false;
+
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		const char* open = strchr(line, '{');
+		int x, y, w, h;
+		if (open != NULL && sscanf(open, "{%d, %d, %d, %d}", &x, &y, &w, &h) == 4)
+			checkpoints.push_back(Checkpoint{ Point{ (float)x, (float)y }, (float)w, (float)h });
+	}
+
+	fclose(file);
+	return checkpoints.size() >= 3;
+}
+
+static float Distance(const Point& a, const Point& b)
+{
+	return sqrtf((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+}
+
+static Point Lerp(const Point& a, const Point& b, float t)
+{
+	return Point{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+// Centripetal Catmull-Rom between p1 and p2 (no cusps or self intersections on uneven spacing)
+static Point CatmullRom(const Point& p0, const Point& p1, const Point& p2, const Point& p3, float t)
+{
+	float t0 = 0.0f;
+	float t1 = t0 + sqrtf(fmaxf(Distance(p0, p1), 1e-3f));
+	float t2 = t1 + sqrtf(fmaxf(Distance(p1, p2), 1e-3f));
+	float t3 = t2 + sqrtf(fmaxf(Distance(p2, p3), 1e-3f));
+	float u = t1 + (t2 - t1) * t;
+
+	Point a1 = Lerp(p0, p1, (u - t0) / (t1 - t0));
+	Point a2 = Lerp(p1, p2, (u - t1) / (t2 - t1));
+	Point a3 = Lerp(p2, p3, (u - t2) / (t3 - t2));
+	Point b1 = Lerp(a1, a2, (u - t0) / (t2 - t0));
+	Point b2 = Lerp(a2, a3, (u - t1) / (t3 - t1));
+	return Lerp(b1, b2, (u - t1) / (t2 - t1));
+}
+
+// Closed spline through every point, steps points per segment
+static std::vector<Point> Spline(const std::vector<Point>& points, int steps)
+{
+	int count = (int)points.size();
+	std::vector<Point> out;
+	out.reserve(count * steps);
+
+	for (int i = 0; i < count; ++i)
+	{
+		const Point& p0 = points[(i + count - 1) % count];
+		const Point& p1 = points[i];
+		const Point& p2 = points[(i + 1) % count];
+		const Point& p3 = points[(i + 2) % count];
+
+		for (int s = 0; s < steps; ++s)
+			out.push_back(CatmullRom(p0, p1, p2, p3, (float)s / steps));
+	}
+
+	return out;
+}
+
+// Closed polyline resampled every spacing pixels
+static std::vector<Point> Resample(const std::vector<Point>& line, float spacing)
+{
+	int count = (int)line.size();
+	float total = 0.0f;
+	for (int i = 0; i < count; ++i)
+		total += Distance(line[i], line[(i + 1) % count]);
+
+	int samples = (int)(total / spacing + 0.5f);
+	float step = total / (float)samples;
+
+	std::vector<Point> out;
+	out.reserve(samples);
+
+	int segment = 0;
+	float segment_start = 0.0f;
+	float segment_length = Distance(line[0], line[1 % count]);
+
+	for (int i = 0; i < samples; ++i)
+	{
+		float d = i * step;
+		while (d > segment_start + segment_length && segment < count - 1)
+		{
+			segment_start += segment_length;
+			segment++;
+			segment_length = Distance(line[segment], line[(segment + 1) % count]);
+		}
+
+		float t = segment_length > 0.0f ? (d - segment_start) / segment_length : 0.0f;
+		out.push_back(Lerp(line[segment], line[(segment + 1) % count], t));
+	}
+
+	return out;
+}
+
+int main(int argc, char** argv)
+{
+	const char* input = NULL;
+	const char* output = NULL;
+	float spacing = 16.0f;
+	float max_offset = 60.0f;
+	float margin = 30.0f;
+	float lateral_accel = 40.0f;
+	float braking = CAR_ACCELERATION;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--spacing") == 0 && i + 1 < argc) spacing = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--max-offset") == 0 && i + 1 < argc) max_offset = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--margin") == 0 && i + 1 < argc) margin = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--lateral-accel") == 0 && i + 1 < argc) lateral_accel = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--braking") == 0 && i + 1 < argc) braking = (float)atof(argv[++i]);
+		else if (input == NULL) input = argv[i];
+		else if (output == NULL) output = argv[i];
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (input == NULL || output == NULL || spacing <= 0.0f || lateral_accel <= 0.0f || braking <= 0.0f)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Checkpoint> checkpoints;
+	if (!ReadCheckpoints(input, checkpoints))
+	{
+		printf("Cannot read checkpoints from %s\n", input);
+		return EXIT_FAILURE;
+	}
+
+	int count = (int)checkpoints.size();
+
+	// ---- Center line: spline through the checkpoint centers ----
+	std::vector<Point> centers;
+	for (const Checkpoint& cp : checkpoints)
+		centers.push_back(cp.center);
+
+	std::vector<Point> spline = Spline(centers, 32);
+
+	// The line is fitted on a coarse copy, a point every 64 px: the smoothing
+	// below spreads slowly and only converges in a few thousand steps there
+	std::vector<Point> center = Resample(spline, 64.0f);
+	int points = (int)center.size();
+
+	// The car has to touch every checkpoint to count the lap: the point closest to
+	// each one is pinned inside its rectangle, margin away from the edges
+	std::vector<int> pinned(points, -1);
+	for (int k = 0; k < count; ++k)
+	{
+		int closest = 0;
+		for (int i = 1; i < points; ++i)
+		{
+			if (Distance(center[i], checkpoints[k].center) < Distance(center[closest], checkpoints[k].center))
+				closest = i;
+		}
+		pinned[closest] = k;
+	}
+
+	// ---- Racing line: relax the fourth difference of the points (how fast their
+	// curvature changes) towards zero, every point kept within max_offset of the
+	// center line and inside its checkpoint. Converges to a smooth, wide path
+	std::vector<Point> line = center;
+	std::vector<Point> next(points);
+	for (int iteration = 0; iteration < 5000; ++iteration)
+	{
+		for (int i = 0; i < points; ++i)
+		{
+			const Point& a = line[(i + points - 2) % points];
+			const Point& b = line[(i + points - 1) % points];
+			const Point& c = line[(i + 1) % points];
+			const Point& d = line[(i + 2) % points];
+			Point smooth = { (4.0f * (b.x + c.x) - a.x - d.x) / 6.0f, (4.0f * (b.y + c.y) - a.y - d.y) / 6.0f };
+			Point p = Lerp(line[i], smooth, 0.5f);
+
+			float offset = Distance(center[i], p);
+			if (offset > max_offset) p = Lerp(center[i], p, max_offset / offset);
+
+			if (pinned[i] >= 0)
+			{
+				const Checkpoint& cp = checkpoints[pinned[i]];
+				float reach_x = fmaxf(cp.width * 0.5f - margin, 0.0f);
+				float reach_y = fmaxf(cp.height * 0.5f - margin, 0.0f);
+				p.x = fminf(fmaxf(p.x, cp.center.x - reach_x), cp.center.x + reach_x);
+				p.y = fminf(fmaxf(p.y, cp.center.y - reach_y), cp.center.y + reach_y);
+			}
+
+			next[i] = p;
+		}
+		line.swap(next);
+	}
+
+	line = Resample(Spline(line, 16), spacing);
+	int samples = (int)line.size();
+
+	float length = 0.0f;
+	for (int i = 0; i < samples; ++i)
+		length += Distance(line[i], line[(i + 1) % samples]);
+	float step = length / (float)samples;
+
+	// ---- Curvature over a 3 x 48 px window, noise from the sampling averages out ----
+	std::vector<RacingLineSample> out(samples);
+	int window = (int)fmaxf(1.0f, 48.0f / step);
+
+	for (int i = 0; i < samples; ++i)
+	{
+		const Point& a = line[(i + samples - window) % samples];
+		const Point& b = line[i];
+		const Point& c = line[(i + window) % samples];
+
+		float cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+		float denominator = Distance(a, b) * Distance(b, c) * Distance(a, c);
+
+		out[i].x = b.x;
+		out[i].y = b.y;
+		out[i].curvature = denominator > 0.0f ? 2.0f * cross / denominator : 0.0f;
+	}
+
+	// ---- Speed profile: cornering limit, then brake points walking the lap backwards ----
+	float step_m = step / PIXELS_PER_METER;
+
+	for (int i = 0; i < samples; ++i)
+	{
+		float curvature_m = fabsf(out[i].curvature) * PIXELS_PER_METER;
+		float v = curvature_m > 0.0f ? sqrtf(lateral_accel / curvature_m) : CAR_MAX_SPEED;
+		out[i].speed = fminf(v, CAR_MAX_SPEED);
+	}
+
+	// Twice around so the braking zone before the start line is included
+	for (int n = 2 * samples - 1; n >= 0; --n)
+	{
+		int i = n % samples;
+		float after = out[(i + 1) % samples].speed;
+		out[i].speed = fminf(out[i].speed, sqrtf(after * after + 2.0f * braking * step_m));
+	}
+
+	// Lap time estimate, accelerating out of every corner at the car's rate
+	float lap_time = 0.0f;
+	float v = out[0].speed;
+	float min_speed = CAR_MAX_SPEED;
+	for (int i = 0; i < samples; ++i)
+	{
+		v = fminf(out[i].speed, sqrtf(v * v + 2.0f * CAR_ACCELERATION * step_m));
+		lap_time += step_m / fmaxf(v, 0.1f);
+		min_speed = fminf(min_speed, out[i].speed);
+	}
+
+	// ---- Write ----
+	FILE* file = fopen(output, "wb");
+	if (file == NULL)
+	{
+		printf("Cannot write %s\n", output);
+		return EXIT_FAILURE;
+	}
+
+	RacingLineHeader header;
+	header.magic = RACING_LINE_MAGIC;
+	header.version = RACING_LINE_VERSION;
+	header.sample_count = (uint32_t)samples;
+	header.spacing = step;
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(out.data(), sizeof(RacingLineSample), out.size(), file) == out.size();
+	fclose(file);
+
+	if (!ok)
+	{
+		printf("Cannot write %s\n", output);
+		return EXIT_FAILURE;
+	}
+
+	printf("%s: %d checkpoints -> %d samples every %.1f px, lap %.0f px\n", output, count, samples, step, length);
+	printf("speed %.1f..%.1f m/s, estimated lap %.1f s, %d bytes\n", min_speed, CAR_MAX_SPEED, lap_time,
+		(int)(sizeof(header) + out.size() * sizeof(RacingLineSample)));
+
+	return EXIT_SUCCESS;
+}
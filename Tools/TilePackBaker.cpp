@@ -0,0 +1,195 @@
+// ----------------------------------------------------
+// TilePackBaker.cpp
+// Offline tool: decodes the track map once and cuts it in the
+// tile pack that TileMap maps at runtime (see TilePack.h)
+//
+// usage: TilePackBaker <map.png> <out.tilepack> [--tile-size N] [--rgb565]
+// ----------------------------------------------------
+
+#ifndef _WIN32
+	#define _FILE_OFFSET_BITS 64    // off_t for fseeko, packs go past 2 GB
+#endif
+
+#include "raylib.h"
+#include "TilePack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static void PrintUsage()
+{
+	printf("usage: TilePackBaker <map.png> <out.tilepack> [--tile-size N] [--rgb565]\n");
+	printf("  --tile-size N  tile edge in pixels (default 512, at most %d)\n", TILE_PACK_MAX_TILE_SIZE);
+	printf("  --rgb565       store 16 bit tiles, half the size of the default RGB888\n");
+}
+
+// fseek takes a long, 32 bit on Windows, and the payloads go past 2 GB
+static bool SeekTo(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+	return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+int main(int argc, char** argv)
+{
+	const char* input = NULL;
+	const char* output = NULL;
+	int tile_size = 512;
+	bool rgb565 = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc) tile_size = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--rgb565") == 0) rgb565 = true;
+		else if (input == NULL) input = argv[i];
+		else if (output == NULL) output = argv[i];
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (input == NULL || output == NULL || tile_size <= 0 || tile_size > TILE_PACK_MAX_TILE_SIZE)
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	Image map = LoadImage(input);
+	if (map.data == NULL)
+	{
+		printf("TilePackBaker: cannot load %s\n", input);
+		return EXIT_FAILURE;
+	}
+
+	if (rgb565) ImageFormat(&map, PIXELFORMAT_UNCOMPRESSED_R5G6B5);
+	else if (map.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8 && map.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+		ImageFormat(&map, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+	int bytes_per_pixel = GetPixelDataSize(1, 1, map.format);
+	uint32_t tile_bytes = (uint32_t)(tile_size * tile_size * bytes_per_pixel);
+
+	TilePackHeader header = {};
+	header.magic = TILE_PACK_MAGIC;
+	header.version = TILE_PACK_VERSION;
+	header.tile_size = (uint32_t)tile_size;
+	header.pixel_format = (uint32_t)map.format;
+
+	// Level sizes first, halving until the whole map fits in one tile
+	int level_width = map.width;
+	int level_height = map.height;
+	while (true)
+	{
+		if (header.level_count == TILE_PACK_MAX_LEVELS)
+		{
+			printf("TilePackBaker: %s needs more than %d levels, use a bigger --tile-size\n", input, TILE_PACK_MAX_LEVELS);
+			UnloadImage(map);
+			return EXIT_FAILURE;
+		}
+
+		TilePackLevel& level = header.levels[header.level_count++];
+		level.width = (uint32_t)level_width;
+		level.height = (uint32_t)level_height;
+		level.tiles_x = (uint32_t)((level_width + tile_size - 1) / tile_size);
+		level.tiles_y = (uint32_t)((level_height + tile_size - 1) / tile_size);
+		level.first_entry = header.tile_count;
+		header.tile_count += level.tiles_x * level.tiles_y;
+
+		if (level_width <= tile_size && level_height <= tile_size) break;
+		level_width = (level_width + 1) / 2;
+		level_height = (level_height + 1) / 2;
+	}
+
+	// Payloads start page aligned so uploading a tile only touches its own pages
+	std::vector<TilePackEntry> entries(header.tile_count);
+	uint64_t offset = AlignUp(sizeof(TilePackHeader) + entries.size() * sizeof(TilePackEntry), TILE_PACK_ALIGNMENT);
+	for (TilePackEntry& entry : entries)
+	{
+		entry.offset = offset;
+		entry.size = tile_bytes;
+		entry.reserved = 0;
+		offset = AlignUp(offset + tile_bytes, TILE_PACK_ALIGNMENT);
+	}
+
+	FILE* file = fopen(output, "wb");
+	if (file == NULL)
+	{
+		printf("TilePackBaker: cannot create %s\n", output);
+		UnloadImage(map);
+		return EXIT_FAILURE;
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(entries.data(), sizeof(TilePackEntry), entries.size(), file) == entries.size();
+
+	std::vector<unsigned char> tile(tile_bytes);
+	size_t dst_pitch = (size_t)tile_size * bytes_per_pixel;
+
+	for (uint32_t l = 0; l < header.level_count && ok; ++l)
+	{
+		const TilePackLevel& level = header.levels[l];
+
+		// Every level is resized from the previous one, cheaper and sharper than from level 0
+		if (l > 0) ImageResize(&map, (int)level.width, (int)level.height);
+
+		const unsigned char* pixels = (const unsigned char*)map.data;
+		size_t src_pitch = (size_t)map.width * bytes_per_pixel;
+
+		for (uint32_t ty = 0; ty < level.tiles_y && ok; ++ty)
+		{
+			for (uint32_t tx = 0; tx < level.tiles_x && ok; ++tx)
+			{
+				int x0 = (int)tx * tile_size;
+				int y0 = (int)ty * tile_size;
+				int w = (map.width - x0 < tile_size) ? map.width - x0 : tile_size;
+				int h = (map.height - y0 < tile_size) ? map.height - y0 : tile_size;
+
+				for (int row = 0; row < h; ++row)
+					memcpy(&tile[row * dst_pitch], pixels + (y0 + row) * src_pitch + (size_t)x0 * bytes_per_pixel, (size_t)w * bytes_per_pixel);
+
+				// Edge tiles repeat their last column and row over the padding, bilinear
+				// filtering at the map edge then blends in the edge colour, not black
+				for (int row = 0; row < h && w < tile_size; ++row)
+				{
+					unsigned char* line = &tile[row * dst_pitch];
+					for (int x = w; x < tile_size; ++x)
+						memcpy(line + (size_t)x * bytes_per_pixel, line + (size_t)(w - 1) * bytes_per_pixel, bytes_per_pixel);
+				}
+				for (int row = h; row < tile_size; ++row)
+					memcpy(&tile[row * dst_pitch], &tile[(h - 1) * dst_pitch], dst_pitch);
+
+				const TilePackEntry& entry = entries[level.first_entry + ty * level.tiles_x + tx];
+				ok = SeekTo(file, entry.offset);
+				ok = ok && fwrite(tile.data(), 1, tile.size(), file) == tile.size();
+			}
+		}
+	}
+
+	fclose(file);
+	UnloadImage(map);
+
+	if (!ok)
+	{
+		printf("TilePackBaker: failed writing %s\n", output);
+		remove(output);
+		return EXIT_FAILURE;
+	}
+
+	printf("TilePackBaker: %s %ux%u -> %s, %u levels, %u tiles of %d px, %.1f MB\n",
+		input, header.levels[0].width, header.levels[0].height, output, header.level_count, header.tile_count, tile_size, offset / (1024.0 * 1024.0));
+
+	return EXIT_SUCCESS;
+}